@@ -7,6 +7,32 @@ namespace DataGenerator {
     const std::filesystem::path dataPath = std::filesystem::current_path() / "data";
     const std::filesystem::path basePath = dataPath / "baseFiles";
 
+    /**
+     * @struct EdgeProfile
+     * @brief One of the hardware profiles edge servers are drawn from.
+     * @details Kept as text so generated files reproduce the exact literals.
+     */
+    struct EdgeProfile {
+        const char* pcn; ///< Number of cores.
+        const char* pcc; ///< Processing capacity per core.
+        const char* csc; ///< Activation cost.
+    };
+
+    inline constexpr EdgeProfile EDGE_PROFILES[5] = {
+        {"2",  "1.6", "0.00085"},
+        {"4",  "2.3", "0.00097"},
+        {"6",  "2.9", "0.00121"},
+        {"8",  "3.0", "0.00138"},
+        {"10", "3.0", "0.00153"},
+    };
+
+    /// Path of the cached device file with `length` devices.
+    inline std::filesystem::path devicesFile(int length) { return dataPath / "devices" / ("Devices_" + std::to_string(length) + ".txt"); }
+    /// Path of the cached edge server file with `length` servers.
+    inline std::filesystem::path ecFile(int length) { return dataPath / "servers" / ("EC_" + std::to_string(length) + ".txt"); }
+    /// Path of the cached cloud server file with `length` servers.
+    inline std::filesystem::path ccFile(int length) { return dataPath / "servers" / ("CC_" + std::to_string(length) + ".txt"); }
+
     /**
      * @brief Generates or reads the services data file.
      * @details This function first checks if 'Services.txt' exists in the base path.
@@ -16,11 +42,12 @@ namespace DataGenerator {
      * based on its characteristics. The newly generated data is then written to
      * 'data/baseFiles/Services.txt' to be reused in subsequent runs.
      *
+     * @param[in,out] rng The random number context used when the file must be generated.
      * @return A 2D vector of strings (`std::vector<std::vector<std::string>>`)
      * containing the service data, including a header row. Returns an empty matrix
      * on error, such as a failure to write the new file.
      */
-    inline std::vector<std::vector<std::string>> servicesData() {
+    inline std::vector<std::vector<std::string>> servicesData(utils::Rng& rng) {
         std::filesystem::path servicePath = basePath / "Services.txt";
         if (std::filesystem::exists(servicePath)) {
             return FileManager::read(servicePath.string(), ' ').value_or(std::vector<std::vector<std::string>>{});
@@ -31,15 +58,15 @@ namespace DataGenerator {
 
         const int numServices = 5;
         for (int i = 1; i <= numServices; ++i) {
-            int tsk = utils::randomNumber(1, 4);
-            int pcn = utils::randomNumber(1, 4);
-            double s_d = utils::randomNumber(0.00484, 12.0);
+            int tsk = utils::randomNumber(rng, 1, 4);
+            int pcn = utils::randomNumber(rng, 1, 4);
+            double s_d = utils::randomNumber(rng, 0.00484, 12.0);
             double pcc = 0.0, mem = 0.0, sto = 0.0;
 
             for (int j = 0; j < tsk; ++j) {
-                pcc += utils::randomNumber(0.00001, 2.5);
-                mem += utils::randomNumber(0.00001, 2.5);
-                sto += utils::randomNumber(0.00001, 15.0);
+                pcc += utils::randomNumber(rng, 0.00001, 2.5);
+                mem += utils::randomNumber(rng, 0.00001, 2.5);
+                sto += utils::randomNumber(rng, 0.00001, 15.0);
             }
 
             double cnd = 0.0;
@@ -76,16 +103,17 @@ namespace DataGenerator {
      * to each one. The new file is saved for future use.
      *
      * @param[in] length The number of devices to include in the file.
+     * @param[in,out] rng The random number context used when the file must be generated.
      * @return A `std::vector<std::vector<std::string>>` containing the device data with a
      * header. Returns an empty matrix on error (e.g., base files not found).
      */
-    inline std::vector<std::vector<std::string>> devicesData(int length) {
-        std::filesystem::path deviceFilePath = dataPath / "devices" / ("Devices_" + std::to_string(length) + ".txt");
+    inline std::vector<std::vector<std::string>> devicesData(int length, utils::Rng& rng) {
+        std::filesystem::path deviceFilePath = devicesFile(length);
         if (std::filesystem::exists(deviceFilePath)) {
             return FileManager::read(deviceFilePath.string(), ' ').value_or(std::vector<std::vector<std::string>>{});
         }
 
-        std::vector<std::vector<std::string>> services = servicesData();
+        std::vector<std::vector<std::string>> services = servicesData(rng);
         if (services.size() <= 1) {
             std::cerr << "Error: No services data available." << std::endl;
             return {};
@@ -102,11 +130,11 @@ namespace DataGenerator {
         std::vector<std::vector<std::string>> devices;
         devices.push_back({"#", "LAT", "LON", "CND", "PCC", "PCN", "MEM", "STO", "S_d", "SVC"});
 
-        std::vector<int> randomIndexes = utils::shuffledRange(0, (int)devices1000.size() - 1);
+        std::vector<int> randomIndexes = utils::shuffledRange(rng, 0, (int)devices1000.size() - 1);
 
         for (int i = 0; i < length; ++i) {
             const auto& sourceDeviceRow = devices1000.at(randomIndexes[i]);
-            const auto& sourceServiceRow = services.at(utils::randomNumber(1, (int)services.size() - 1));
+            const auto& sourceServiceRow = services.at(utils::randomNumber(rng, 1, (int)services.size() - 1));
 
             devices.push_back({
                 utils::toString(i + 1),
@@ -141,7 +169,7 @@ namespace DataGenerator {
      * Returns an empty matrix on error.
      */
     inline std::vector<std::vector<std::string>> ccData(int length) {
-        std::filesystem::path serverFilePath = dataPath / "servers" / ("CC_" + std::to_string(length) + ".txt");
+        std::filesystem::path serverFilePath = ccFile(length);
         if (std::filesystem::exists(serverFilePath)) {
             return FileManager::read(serverFilePath.string(), ' ').value_or(std::vector<std::vector<std::string>>{});
         }
@@ -178,11 +206,12 @@ namespace DataGenerator {
      * the new data to the 'servers' directory.
      *
      * @param[in] length The number of servers, corresponding to the base file name.
+     * @param[in,out] rng The random number context used when the file must be generated.
      * @return A `std::vector<std::vector<std::string>>` containing the EC server data.
      * Returns an empty matrix on error.
      */
-    inline std::vector<std::vector<std::string>> ecData(int length) {
-        std::filesystem::path serverFilePath = dataPath / "servers" / ("EC_" + std::to_string(length) + ".txt");
+    inline std::vector<std::vector<std::string>> ecData(int length, utils::Rng& rng) {
+        std::filesystem::path serverFilePath = ecFile(length);
         if (std::filesystem::exists(serverFilePath)) {
             return FileManager::read(serverFilePath.string(), ' ').value_or(std::vector<std::vector<std::string>>{});
         }
@@ -200,17 +229,12 @@ namespace DataGenerator {
 
         for (const auto& s : sourceData) {
             if (s.at(0) == "#") continue;
-            int raffle = utils::randomNumber(1, 5);
-            std::string pcn, pcc, csc;
-
-            if      (raffle == 1) { pcn = "2";  pcc = "1.6"; csc = "0.00085";}
-            else if (raffle == 2) { pcn = "4";  pcc = "2.3"; csc = "0.00097";}
-            else if (raffle == 3) { pcn = "6";  pcc = "2.9"; csc = "0.00121";}
-            else if (raffle == 4) { pcn = "8";  pcc = "3.0"; csc = "0.00138";}
-            else                  { pcn = "10"; pcc = "3.0"; csc = "0.00153";}
+            int raffle = utils::randomNumber(rng, 1, 5);
+            const EdgeProfile& profile = EDGE_PROFILES[raffle - 1];
+            std::string pcn = profile.pcn, pcc = profile.pcc, csc = profile.csc;
 
-            double mem = utils::randomNumber(0.00001, 125.0);
-            double sto = utils::randomNumber(0.00001, 1000.0);
+            double mem = utils::randomNumber(rng, 0.00001, 125.0);
+            double sto = utils::randomNumber(rng, 0.00001, 1000.0);
             double t_p = 12.5 / std::stod(pcc);
 
             ec.push_back({
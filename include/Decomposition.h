@@ -0,0 +1,424 @@
+#pragma once
+
+#include "NetworkResourceAllocation.h"
+#include "Parallel.h"
+#include "structs.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <optional>
+#include <vector>
+
+/**
+ * @namespace Decomposition
+ * @brief Splits an instance into geographic clusters that are solved one by one.
+ * @details Coverage is local: a device only reaches the edge servers around it, plus the
+ * cloud servers every device shares. The covered devices are cut into clusters by
+ * recursive coordinate bisection, and every edge server joins the cluster holding most
+ * of the devices it can reach. Each cluster becomes a sub-state of its own (its
+ * devices, its edge servers and every cloud server) that any allocation algorithm can
+ * solve, so the clusters can be solved concurrently. Candidate pairs between a device
+ * and an edge server of another cluster are cut.
+ *
+ * The cloud capacity is divided between the clusters, lane by lane, in proportion to
+ * the demand of the devices that can reach each cloud server; the shares never add up
+ * to more than the server's capacity, so the merged solution is always feasible.
+ * Between rounds, a master step hands the capacity a cluster left unused to the
+ * clusters with unserved devices that could use it, in proportion to their unserved
+ * demand, and every cluster is solved again from its previous solution (which still
+ * fits its new shares). A cluster pays the full activation cost of every cloud
+ * server it uses, which overstates the cost only when several clusters share one.
+ */
+namespace Decomposition {
+    /**
+     * @struct Options
+     * @brief The size of the clusters and the number of coordination rounds.
+     */
+    struct Options {
+        int maxDevices = 2000;    ///< Largest number of devices in a cluster.
+        int rounds = 3;           ///< Solves of every cluster, with the cloud capacity divided anew in between.
+        unsigned concurrent = 0;  ///< Clusters solved at a time (0: one per core, up to the number of clusters).
+    };
+
+    /**
+     * @struct Cluster
+     * @brief Devices solved together and the edge servers only they may use.
+     */
+    struct Cluster {
+        iVec devices;     ///< Global indices of the devices, in ascending order.
+        iVec edgeServers; ///< Global indices of the edge servers, in ascending order.
+    };
+
+    /**
+     * @struct Subproblem
+     * @brief The sub-state of one cluster and the maps back to the full instance.
+     * @details Devices and servers are renumbered from 1, with the usual placeholder at
+     * index 0. The edge servers of the cluster come first, then every cloud server, its
+     * capacity set to the cluster's share. Cloud candidates keep the global id of the
+     * edge server they route through.
+     */
+    struct Subproblem {
+        Result state;
+        iVec devices; ///< Global index of each device of the sub-state (0 for the placeholder).
+        iVec servers; ///< Global index of each server of the sub-state (0 for the placeholder).
+        int firstCloud = 1; ///< Sub-state index of the first cloud server.
+        int cluster = 0;    ///< Position of the cluster in the partition.
+    };
+
+    /**
+     * @struct Stats
+     * @brief How an instance was decomposed.
+     */
+    struct Stats {
+        int clusters = 0;
+        int rounds = 0;      ///< Rounds actually run; fewer than requested once no cluster wants more cloud capacity.
+        size_t cutPairs = 0; ///< Device-edge server candidate pairs lost between clusters.
+    };
+
+    /// The five capacity lanes of a server or demand of a device: PCC, PCN, MEM, STO, BW.
+    using Lanes = std::array<double, 5>;
+
+    inline Lanes demand(const Device& device) { return {device.pcc, (double) device.pcn, device.mem, device.sto, device.bw}; }
+    inline Lanes capacity(const Server& server) { return {server.pcc_total, (double) server.pcn, server.mem, server.sto, server.bw}; }
+
+    namespace {
+        /**
+         * @brief Cuts `ids[begin, end)` at the median of its widest extent until every part fits in a cluster.
+         */
+        inline void bisect(const Devices& devices, iVec& ids, size_t begin, size_t end, size_t maxDevices, std::vector<Cluster>& out) {
+            if (end - begin <= maxDevices) {
+                Cluster cluster;
+                cluster.devices.assign(ids.begin() + begin, ids.begin() + end);
+                std::sort(cluster.devices.begin(), cluster.devices.end());
+                out.push_back(std::move(cluster));
+                return;
+            }
+            double minLat = 90.0, maxLat = -90.0, minLon = 180.0, maxLon = -180.0;
+            for (size_t k = begin; k < end; ++k) {
+                const Device& device = devices[ids[k]];
+                minLat = std::min(minLat, (double) device.lat);
+                maxLat = std::max(maxLat, (double) device.lat);
+                minLon = std::min(minLon, (double) device.lon);
+                maxLon = std::max(maxLon, (double) device.lon);
+            }
+            // A degree of longitude shrinks with the cosine of the latitude.
+            const double lonScale = std::cos((minLat + maxLat) * 0.5 * (double) utils::PI_L / 180.0);
+            const bool byLat = (maxLat - minLat) >= (maxLon - minLon) * lonScale;
+
+            const size_t mid = begin + (end - begin) / 2;
+            std::nth_element(ids.begin() + begin, ids.begin() + mid, ids.begin() + end, [&](int a, int b) {
+                const double ka = byLat ? devices[a].lat : devices[a].lon, kb = byLat ? devices[b].lat : devices[b].lon;
+                return ka < kb || (ka == kb && a < b);
+            });
+            bisect(devices, ids, begin, mid, maxDevices, out);
+            bisect(devices, ids, mid, end, maxDevices, out);
+        }
+
+        /**
+         * @brief Sets a cloud server's share of a sub-state, keeping the residual capacity of its ledger consistent.
+         */
+        inline void setShare(Result& sub, int j, const Lanes& share) {
+            Server& server = sub.servers[j];
+            CapacityLedger& ledger = sub.ledger;
+            ledger.pcc[j] += share[0] - server.pcc_total;
+            ledger.pcn[j] += (int) share[1] - server.pcn;
+            ledger.mem[j] += share[2] - server.mem;
+            ledger.sto[j] += share[3] - server.sto;
+            ledger.bw[j]  += share[4] - server.bw;
+            server.pcc_total = share[0];
+            server.pcn = (int) share[1];
+            server.mem = share[2];
+            server.sto = share[3];
+            server.bw = share[4];
+        }
+
+        /**
+         * @brief Divides each lane of `total` in proportion to `weights`, the PCN lane in whole cores.
+         * @details Whole cores left over by the flooring go to the heaviest weight. With no
+         * weight at all, the lane is split evenly.
+         * @return One share per weight; the shares of a lane never add up to more than its total.
+         */
+        inline std::vector<Lanes> divide(const Lanes& total, const std::vector<Lanes>& weights) {
+            std::vector<Lanes> shares(weights.size(), Lanes{});
+            for (size_t r = 0; r < total.size(); ++r) {
+                double sum = 0.0;
+                size_t heaviest = 0;
+                for (size_t c = 0; c < weights.size(); ++c) {
+                    sum += weights[c][r];
+                    if (weights[c][r] > weights[heaviest][r]) heaviest = c;
+                }
+                double given = 0.0;
+                for (size_t c = 0; c < weights.size(); ++c) {
+                    double share = total[r] * (sum > 0.0 ? weights[c][r] / sum : 1.0 / weights.size());
+                    // Shares are rounded down, so that rounding errors never add up to more than the total.
+                    share = r == 1 ? std::floor(share) : share * (1.0 - 1e-12);
+                    shares[c][r] = share;
+                    given += share;
+                }
+                if (r == 1 && !weights.empty()) shares[heaviest][r] += std::max(0.0, std::floor(total[r] - given));
+            }
+            return shares;
+        }
+
+        /**
+         * @brief Releases every device of a state.
+         */
+        inline void clearAllocation(Result& state) {
+            for (int d : state.coveredDevicesIdx) NetworkResourceAllocation::release(state, state.devices[d]);
+        }
+    }
+
+    /**
+     * @brief Partitions the covered devices and the edge servers of a state into clusters.
+     * @param[in] state The pre-calculated state.
+     * @param[in] maxDevices The largest number of devices in a cluster.
+     * @return The clusters, never empty when some device is covered.
+     */
+    inline std::vector<Cluster> partition(const Result& state, int maxDevices) {
+        std::vector<Cluster> clusters;
+        iVec ids = state.coveredDevicesIdx;
+        if (ids.empty()) return clusters;
+        bisect(state.devices, ids, 0, ids.size(), (size_t) std::max(maxDevices, 1), clusters);
+
+        // Every edge server joins the cluster holding most of the devices that can reach it.
+        const CandidateTable& candidates = *state.candidates;
+        std::vector<iVec> votes(state.servers.size());
+        for (size_t c = 0; c < clusters.size(); ++c) {
+            for (int d : clusters[c].devices) {
+                for (int slot = candidates.first(d); slot < candidates.last(d); ++slot) {
+                    const int j = candidates.serverIds[slot];
+                    if (state.servers[j].type == 'E') votes[j].push_back((int) c);
+                }
+            }
+        }
+        for (size_t j = 1; j < votes.size(); ++j) {
+            if (votes[j].empty()) continue;
+            std::sort(votes[j].begin(), votes[j].end());
+            int best = votes[j][0], bestCount = 0;
+            for (size_t k = 0; k < votes[j].size();) {
+                size_t next = k;
+                while (next < votes[j].size() && votes[j][next] == votes[j][k]) ++next;
+                if ((int) (next - k) > bestCount) {
+                    best = votes[j][k];
+                    bestCount = (int) (next - k);
+                }
+                k = next;
+            }
+            clusters[best].edgeServers.push_back((int) j);
+        }
+        return clusters;
+    }
+
+    /**
+     * @brief Builds the sub-state of a cluster, with no allocation and the full capacity on every cloud server.
+     * @param[in] state The full state.
+     * @param[in] cluster The cluster.
+     * @param[in] cloudServers The global indices of the cloud servers.
+     * @param[in,out] cutPairs Incremented by the candidate pairs to edge servers of other clusters.
+     */
+    inline Subproblem extract(const Result& state, const Cluster& cluster, const iVec& cloudServers, size_t& cutPairs) {
+        const CandidateTable& candidates = *state.candidates;
+        iVec local(state.servers.size(), 0);
+
+        Servers servers{state.servers[0]};
+        iVec serverMap{0};
+        for (const iVec* group : {&cluster.edgeServers, &cloudServers}) {
+            for (int j : *group) {
+                local[j] = (int) servers.size();
+                serverMap.push_back(j);
+                servers.push_back(state.servers[j]);
+                servers.back().id = local[j];
+                servers.back().on = false;
+            }
+        }
+
+        Devices devices{state.devices[0]};
+        iVec deviceMap{0}, covered;
+        auto table = std::make_shared<CandidateTable>();
+        table->offsets = {0, 0};
+        table->edgeOffsets = {0, 0};
+        table->routes.resize(1);
+        table->cloudProcessing = candidates.cloudProcessing;
+        table->cloudLegs = candidates.cloudLegs;
+        for (int d : cluster.devices) {
+            const int id = (int) devices.size();
+            devices.push_back(state.devices[d]);
+            devices.back().id = id;
+            devices.back().served = false;
+            devices.back().server = server_covering();
+            deviceMap.push_back(d);
+            // Cloud slots keep their position after the edges, so the device's route still times them.
+            for (int slot = candidates.first(d); slot < candidates.last(d); ++slot) {
+                const int j = local[candidates.serverIds[slot]];
+                if (j == 0) {
+                    ++cutPairs;
+                    continue;
+                }
+                table->serverIds.push_back(j);
+                const int e = slot - candidates.first(d);
+                if (e < candidates.edgeCount(d)) {
+                    table->edgeDistances.push_back(candidates.edgeDistances[candidates.edgeOffsets[d] + e]);
+                    table->edgeResponseTimes.push_back(candidates.edgeResponseTimes[candidates.edgeOffsets[d] + e]);
+                }
+            }
+            table->offsets.push_back((int) table->serverIds.size());
+            table->edgeOffsets.push_back((int) table->edgeDistances.size());
+            table->routes.push_back(candidates.routes[d]);
+            if (table->count(id) > 0) covered.push_back(id);
+        }
+
+        Subproblem sub{Result(std::move(devices), std::move(servers), std::move(covered), std::move(table), state.metrics ? state.metrics->clone() : nullptr),
+                       std::move(deviceMap), std::move(serverMap), (int) cluster.edgeServers.size() + 1};
+        return sub;
+    }
+
+    /**
+     * @brief Solves a state cluster by cluster and writes the merged allocation into it.
+     * @details See the namespace description. `solveCluster(sub, start)` must allocate the
+     * devices of `sub.state`, which holds no allocation when it is called; `start`, when
+     * not null, is a feasible assignment of the sub-state (indexed by sub-state device,
+     * holding sub-state server indices) to start from. It returns `false` on failure. A
+     * round solves its clusters concurrently, so `solveCluster` must be thread-safe
+     * across different sub-states.
+     *
+     * @param[in,out] state The state to solve; any allocation it holds is discarded.
+     * @param[in] clusters The partition of `state` to solve, as returned by `partition`.
+     * @param[in] options The coordination rounds and concurrency; `maxDevices` is not used.
+     * @param[in] solveCluster The algorithm run on each sub-state.
+     * @param[in] incumbent An optional assignment of the full state, used as the start of the first round.
+     * @return How the instance was decomposed, or `std::nullopt` if a cluster could not be solved (an error is logged).
+     */
+    template <typename SolveFn>
+    inline std::optional<Stats> solve(Result& state, const std::vector<Cluster>& clusters, const Options& options, SolveFn solveCluster, const iVec* incumbent = nullptr) {
+        Stats stats;
+        stats.clusters = (int) clusters.size();
+        clearAllocation(state);
+        if (clusters.empty()) return stats;
+
+        iVec cloudServers;
+        for (size_t j = 1; j < state.servers.size(); ++j) {
+            if (state.servers[j].type != 'E') cloudServers.push_back((int) j);
+        }
+        std::vector<Subproblem> subs;
+        subs.reserve(clusters.size());
+        for (const Cluster& cluster : clusters) {
+            subs.push_back(extract(state, cluster, cloudServers, stats.cutPairs));
+            subs.back().cluster = (int) subs.size() - 1;
+        }
+
+        // Lane-wise demand of the devices that can reach (want = unserved only) each cloud server, per cluster.
+        auto cloudDemand = [&](bool unservedOnly) {
+            std::vector<std::vector<Lanes>> demandOf(cloudServers.size(), std::vector<Lanes>(subs.size(), Lanes{}));
+            for (size_t c = 0; c < subs.size(); ++c) {
+                const Result& sub = subs[c].state;
+                for (int d : sub.coveredDevicesIdx) {
+                    if (unservedOnly && sub.devices[d].served) continue;
+                    const Lanes need = demand(sub.devices[d]);
+                    for (int slot = sub.candidates->first(d); slot < sub.candidates->last(d); ++slot) {
+                        const int k = sub.candidates->serverIds[slot] - subs[c].firstCloud;
+                        if (k < 0) continue;
+                        for (size_t r = 0; r < need.size(); ++r) demandOf[k][c][r] += need[r];
+                    }
+                }
+            }
+            return demandOf;
+        };
+
+        const auto initial = cloudDemand(false);
+        for (size_t k = 0; k < cloudServers.size(); ++k) {
+            const std::vector<Lanes> shares = divide(capacity(state.servers[cloudServers[k]]), initial[k]);
+            for (size_t c = 0; c < subs.size(); ++c) setShare(subs[c].state, subs[c].firstCloud + (int) k, shares[c]);
+        }
+
+        // The incumbent is projected on every cluster, dropping the devices that do not fit its shares.
+        if (incumbent) {
+            for (Subproblem& sub : subs) {
+                iVec local(state.servers.size(), 0);
+                for (size_t j = 1; j < sub.servers.size(); ++j) local[sub.servers[j]] = (int) j;
+                for (int d : sub.state.coveredDevicesIdx) {
+                    const int j = local[(*incumbent)[sub.devices[d]]];
+                    const int slot = j != 0 ? sub.state.candidates->find(d, j) : -1;
+                    Device& device = sub.state.devices[d];
+                    if (slot >= 0 && sub.state.ledger.canServe(j, device)) NetworkResourceAllocation::assign(sub.state, device, sub.state.candidates->entry(device.id, slot));
+                }
+            }
+        }
+
+        const unsigned concurrent = options.concurrent > 0 ? options.concurrent : Parallel::defaultThreads();
+        const int rounds = std::max(options.rounds, 1);
+        for (int round = 0; round < rounds; ++round) {
+            ++stats.rounds;
+            const bool hasStart = round > 0 || incumbent;
+            std::vector<char> solved(subs.size(), 0);
+            Parallel::parallelFor(0, subs.size(), [&](size_t c) {
+                Result& sub = subs[c].state;
+                const iVec start = sub.ledger.assignment;
+                clearAllocation(sub);
+                solved[c] = solveCluster(subs[c], hasStart ? &start : nullptr);
+            }, concurrent, 1);
+            if (std::find(solved.begin(), solved.end(), 0) != solved.end()) {
+                std::cerr << "Error: A cluster of the decomposition could not be solved." << std::endl;
+                return std::nullopt;
+            }
+            if (round + 1 == rounds) break;
+
+            // Master step: the capacity a cluster left unused goes to the clusters with unserved demand for it.
+            const auto unmet = cloudDemand(true);
+            bool wanted = false;
+            for (size_t k = 0; k < cloudServers.size(); ++k) {
+                Lanes pool{};
+                std::vector<Lanes> used(subs.size());
+                for (size_t c = 0; c < subs.size(); ++c) {
+                    const int j = subs[c].firstCloud + (int) k;
+                    const Lanes share = capacity(subs[c].state.servers[j]);
+                    const CapacityLedger& ledger = subs[c].state.ledger;
+                    const Lanes residual{ledger.pcc[j], (double) ledger.pcn[j], ledger.mem[j], ledger.sto[j], ledger.bw[j]};
+                    for (size_t r = 0; r < pool.size(); ++r) {
+                        used[c][r] = share[r] - residual[r];
+                        pool[r] += residual[r];
+                    }
+                }
+                bool any = false;
+                for (const Lanes& want : unmet[k]) {
+                    for (double lane : want) any = any || lane > 0.0;
+                }
+                if (!any) continue;
+                wanted = true;
+
+                const std::vector<Lanes> extra = divide(pool, unmet[k]);
+                for (size_t c = 0; c < subs.size(); ++c) {
+                    Lanes share;
+                    for (size_t r = 0; r < share.size(); ++r) share[r] = used[c][r] + extra[c][r];
+                    setShare(subs[c].state, subs[c].firstCloud + (int) k, share);
+                }
+            }
+            if (!wanted) break;
+        }
+
+        // Merge: every cluster's allocation fits the full state, as edge servers are owned and cloud shares add up.
+        const CandidateTable& candidates = *state.candidates;
+        for (const Subproblem& sub : subs) {
+            for (size_t d = 1; d < sub.devices.size(); ++d) {
+                const int j = sub.state.ledger.assignment[d];
+                if (j == 0) continue;
+                Device& device = state.devices[sub.devices[d]];
+                const int slot = candidates.find(device.id, sub.servers[j]);
+                if (slot >= 0 && state.ledger.canServe(sub.servers[j], device)) {
+                    NetworkResourceAllocation::assign(state, device, candidates.entry(device.id, slot));
+                }
+            }
+        }
+        return stats;
+    }
+
+    /**
+     * @brief Partitions a state with `partition(state, options.maxDevices)` and solves it cluster by cluster.
+     * @details See the overload that takes the clusters; use it when the partition is
+     * also needed beforehand, e.g., to size per-cluster buffers.
+     */
+    template <typename SolveFn>
+    inline std::optional<Stats> solve(Result& state, const Options& options, SolveFn solveCluster, const iVec* incumbent = nullptr) {
+        return solve(state, partition(state, options.maxDevices), options, solveCluster, incumbent);
+    }
+}
@@ -0,0 +1,437 @@
+#pragma once
+
+#include "FileManager.h"
+#include "Heuristics.h"
+#include "InstanceCache.h"
+#include "LowerBounds.h"
+#include "MathModels.h"
+#include "MetaHeuristics.h"
+#include "NetworkResourceAllocation.h"
+#include "Online.h"
+#include "Parallel.h"
+
+#include <functional>
+#include <set>
+
+namespace ExperimentRunner {
+
+    /**
+     * @struct Experiment
+     * @brief An experiment matrix: every combination of the listed values is run.
+     * @details Read from a config file by `load`. Each (devices, servers, tech) data set
+     * is pre-calculated once; each bottleneck setting of it makes an instance, and every
+     * algorithm of the matrix runs on a copy of that instance.
+     */
+    struct Experiment {
+        iVec devices = {300};
+        iVec serversEC = {100};
+        iVec serversCC = {5};
+        iVec techs = {4};
+        iVec bottlenecks = {0};                           ///< 1 to run the instance with the CC bottleneck, 0 without.
+        std::vector<std::string> algorithms;              ///< "Simulation/Algorithm" pairs (e.g., "Heuristic/Random", "MetaHeuristic/SA", "Online/Greedy").
+        std::vector<std::string> heuristics = {"Random"}; ///< Initial solutions of the MetaHeuristic runs.
+        std::vector<double> temperatures = {100.0};       ///< Initial temperatures of the MetaHeuristic runs.
+        std::vector<double> alphas = {0.95};              ///< Cooling rates of the MetaHeuristic runs.
+        int loopTest = 120;                               ///< Repetitions of every MetaHeuristic run.
+        MetaHeuristics::SearchBudget search;              ///< Stopping budget and schedule of every MetaHeuristic repetition.
+        MetaHeuristics::TabuOptions tabu;                 ///< Tenure, sample, stall and kicks of the Tabu and ILS runs.
+        int onlineEvents = 1000;                          ///< Arrivals and departures of every Online run.
+        uint64_t seed = 1;                                ///< Root of every instance seed.
+        unsigned threads = 0;                             ///< Pool workers (0: one per hardware thread).
+        bool resume = true;                               ///< Skip the rows already in the results files.
+        MathModels::SolverConfig solver;                  ///< CPLEX parameters of the Mathematical runs.
+        std::string lowerBound = "None";                  ///< Bound computed once per instance: "Lagrangian", "LP" or "None".
+    };
+
+    /**
+     * @struct Instance
+     * @brief One instance of the matrix: a data set and its bottleneck setting.
+     */
+    struct Instance {
+        int devices = 0;
+        int serversEC = 0;
+        int serversCC = 0;
+        int tech = 0;
+        bool bottlenecks = false;
+        uint64_t seed = 0; ///< Seed of the instance's random context, recorded in every results row.
+    };
+
+    /**
+     * @struct Job
+     * @brief One algorithm run on an instance, as `initializeSimulation` would start it.
+     */
+    struct Job {
+        std::string simulation;
+        std::string algorithm;
+        std::string heuristic;   ///< Initial solution (MetaHeuristic only).
+        double temperature = 0.0;
+        double alpha = 0.0;
+        int firstRepetition = 0; ///< Repetitions already in the results file (MetaHeuristic only).
+    };
+
+    /**
+     * @struct DataSetPlan
+     * @brief The instances of one data set that still have jobs to run.
+     */
+    struct DataSetPlan {
+        int devices, serversEC, serversCC, tech;
+        std::vector<std::pair<Instance, std::vector<Job>>> instances;
+    };
+
+    namespace {
+        inline bool parseInts(const std::vector<std::string>& values, iVec& out) {
+            out.clear();
+            for (const auto& value : values) {
+                int from = 0, to = 0, step = 1;
+                const size_t first = value.find(':');
+                if (first == std::string::npos) {
+                    from = to = std::stoi(value);
+                } else {
+                    const size_t second = value.find(':', first + 1);
+                    from = std::stoi(value.substr(0, first));
+                    to = std::stoi(value.substr(first + 1, second == std::string::npos ? std::string::npos : second - first - 1));
+                    if (second != std::string::npos) step = std::stoi(value.substr(second + 1));
+                }
+                if (step <= 0) return false;
+                for (int v = from; v <= to; v += step) out.push_back(v);
+            }
+            return !out.empty();
+        }
+
+        inline bool parseReals(const std::vector<std::string>& values, std::vector<double>& out) {
+            out.clear();
+            for (const auto& value : values) out.push_back(std::stod(value));
+            return !out.empty();
+        }
+
+        inline int parseInt(const std::vector<std::string>& values) {
+            if (values.size() != 1) throw std::invalid_argument("expected a single value");
+            return std::stoi(values[0]);
+        }
+
+        inline bool parseBoundMethod(const std::vector<std::string>& values, std::string& out) {
+            if (values.size() != 1 || (values[0] != "None" && values[0] != "Lagrangian" && values[0] != "LP")) return false;
+            out = values[0];
+            return true;
+        }
+
+        /**
+         * @brief Sets one key of the matrix.
+         * @return `false` if the key is unknown or its values are invalid (an error is logged).
+         */
+        inline bool apply(Experiment& experiment, const std::string& key, const std::vector<std::string>& values) {
+            try {
+                bool valid = !values.empty();
+                if (key == "devices")             valid = valid && parseInts(values, experiment.devices);
+                else if (key == "servers_ec")     valid = valid && parseInts(values, experiment.serversEC);
+                else if (key == "servers_cc")     valid = valid && parseInts(values, experiment.serversCC);
+                else if (key == "tech")           valid = valid && parseInts(values, experiment.techs);
+                else if (key == "bottlenecks")    valid = valid && parseInts(values, experiment.bottlenecks);
+                else if (key == "algorithms")     experiment.algorithms = values;
+                else if (key == "heuristics")     experiment.heuristics = values;
+                else if (key == "temperature")    valid = valid && parseReals(values, experiment.temperatures);
+                else if (key == "alpha")          valid = valid && parseReals(values, experiment.alphas);
+                else if (key == "loop_test")      experiment.loopTest = parseInt(values);
+                else if (key == "online_events")  experiment.onlineEvents = parseInt(values);
+                else if (key == "search_time")    experiment.search.timeLimitSec = std::stod(values.at(0));
+                else if (key == "search_iterations") experiment.search.maxIterations = std::stoull(values.at(0));
+                else if (key == "stagnation_levels") experiment.search.stagnationLevels = parseInt(values);
+                else if (key == "adaptive_cooling") experiment.search.adaptive = parseInt(values) != 0;
+                else if (key == "tabu_tenure")    experiment.tabu.tenure = parseInt(values);
+                else if (key == "tabu_sample")    experiment.tabu.sample = parseInt(values);
+                else if (key == "tabu_stall")     experiment.tabu.stall = parseInt(values);
+                else if (key == "ils_kicks")      experiment.tabu.kicks = parseInt(values);
+                else if (key == "seed")           experiment.seed = std::stoull(values.at(0));
+                else if (key == "threads")        experiment.threads = (unsigned) std::max(0, parseInt(values));
+                else if (key == "resume")         experiment.resume = parseInt(values) != 0;
+                else if (key == "solver_threads") experiment.solver.threads = parseInt(values);
+                else if (key == "time_limit")     experiment.solver.timeLimit = std::stod(values.at(0));
+                else if (key == "mip_gap")        experiment.solver.mipGap = std::stod(values.at(0));
+                else if (key == "cluster_devices") experiment.solver.decomposition.maxDevices = parseInt(values);
+                else if (key == "cluster_rounds")  experiment.solver.decomposition.rounds = parseInt(values);
+                else if (key == "lower_bound")    valid = valid && parseBoundMethod(values, experiment.lowerBound);
+                else {
+                    std::cerr << "Error: Unknown experiment key '" << key << "'." << std::endl;
+                    return false;
+                }
+                if (!valid) std::cerr << "Error: Invalid values for experiment key '" << key << "'." << std::endl;
+                return valid;
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid values for experiment key '" << key << "'." << std::endl;
+                return false;
+            }
+        }
+
+        /// Mixes the root seed with the values that identify an instance.
+        inline uint64_t mixSeed(uint64_t seed, std::initializer_list<int64_t> values) {
+            uint64_t state = seed;
+            uint64_t hash = utils::splitMix64(state);
+            for (int64_t value : values) {
+                state = hash ^ static_cast<uint64_t>(value);
+                hash = utils::splitMix64(state);
+            }
+            return hash;
+        }
+    }
+
+    /**
+     * @brief Reads an experiment matrix from a config file.
+     * @details One key per line, followed by its space-separated values; `#` starts a
+     * comment. Integer lists also accept inclusive ranges written `from:to:step`. Keys
+     * left out keep the defaults of `Experiment`. Each override has the form
+     * `key=value[,value...]` and replaces the key's values from the file.
+     *
+     * @param[in] path The config file.
+     * @param[in] overrides Command-line overrides, applied after the file.
+     * @return The matrix, or `std::nullopt` if the file cannot be read or has an invalid entry.
+     */
+    inline std::optional<Experiment> load(const std::string& path, const std::vector<std::string>& overrides = {}) {
+        auto rows = FileManager::read(path, ' ');
+        if (!rows) return std::nullopt;
+
+        Experiment experiment;
+        for (auto& row : *rows) {
+            auto comment = std::find_if(row.begin(), row.end(), [](const std::string& token) { return token.front() == '#'; });
+            row.erase(comment, row.end());
+            if (row.empty()) continue;
+            if (!apply(experiment, row[0], std::vector<std::string>(row.begin() + 1, row.end()))) return std::nullopt;
+        }
+
+        for (const auto& entry : overrides) {
+            const size_t equals = entry.find('=');
+            if (equals == std::string::npos) {
+                std::cerr << "Error: Overrides must have the form key=value, got '" << entry << "'." << std::endl;
+                return std::nullopt;
+            }
+            std::vector<std::string> values;
+            std::stringstream list(entry.substr(equals + 1));
+            std::string value;
+            while (std::getline(list, value, ',')) {
+                if (!value.empty()) values.push_back(value);
+            }
+            if (!apply(experiment, entry.substr(0, equals), values)) return std::nullopt;
+        }
+
+        if (experiment.algorithms.empty()) {
+            std::cerr << "Error: The experiment lists no algorithms." << std::endl;
+            return std::nullopt;
+        }
+        return experiment;
+    }
+
+    /**
+     * @brief Returns the seed of an instance.
+     * @details Derived from the root seed and the instance's own values only, so adding
+     * values to the matrix leaves the seeds (and the resumable rows) of the other
+     * instances unchanged. Passing it to `initializeSimulation` replays a row.
+     */
+    inline uint64_t instanceSeed(const Experiment& experiment, int devices, int serversEC, int serversCC, int tech, bool bottlenecks) {
+        return mixSeed(experiment.seed, {devices, serversEC, serversCC, tech, bottlenecks ? 1 : 0});
+    }
+
+    /**
+     * @brief Lists the jobs of the matrix that run on any instance.
+     * @return One job per algorithm, and per (heuristic, temperature, alpha) for MetaHeuristic algorithms.
+     */
+    inline std::vector<Job> jobs(const Experiment& experiment) {
+        std::vector<Job> list;
+        for (const auto& entry : experiment.algorithms) {
+            const size_t slash = entry.find('/');
+            Job job;
+            job.simulation = entry.substr(0, slash);
+            job.algorithm = slash == std::string::npos ? std::string() : entry.substr(slash + 1);
+            if (job.simulation != "MetaHeuristic") {
+                list.push_back(job);
+                continue;
+            }
+            for (const auto& heuristic : experiment.heuristics) {
+                for (double T : experiment.temperatures) {
+                    for (double alpha : experiment.alphas) {
+                        job.heuristic = heuristic;
+                        job.temperature = T;
+                        job.alpha = alpha;
+                        list.push_back(job);
+                    }
+                }
+            }
+        }
+        return list;
+    }
+
+    /**
+     * @brief Checks how much of a job is already in its results file.
+     * @details Rows are matched on the instance seed (and, for MetaHeuristic runs, on the
+     * temperature and alpha), and malformed rows such as one cut short by a crash are
+     * ignored. A MetaHeuristic job resumes at its first missing repetition. Only the
+     * text results format is read.
+     *
+     * @param[in] instance The instance the job runs on.
+     * @param[in,out] job The job; its `firstRepetition` is set.
+     * @param[in] loopTest The repetitions of a MetaHeuristic job.
+     * @return `true` if the job still has rows to produce.
+     */
+    inline bool pending(const Instance& instance, Job& job, int loopTest) {
+        std::unique_ptr<Metrics> metrics;
+        if (job.simulation == "Heuristic" || job.simulation == "Online") {
+            metrics = std::make_unique<HeuristicMetrics>(job.simulation, job.algorithm, instance.devices, instance.serversEC, instance.serversCC, instance.tech);
+        } else if (job.simulation == "Mathematical") {
+            metrics = std::make_unique<MathMetrics>(job.simulation, job.algorithm, instance.devices, instance.serversEC, instance.serversCC, instance.tech);
+        } else {
+            metrics = std::make_unique<MetaHeuristicMetrics>(job.simulation, job.algorithm, instance.devices, instance.serversEC, instance.serversCC, instance.tech,
+                                                             job.temperature, job.alpha, job.heuristic);
+        }
+        const std::filesystem::path file = metrics->getBaseDirectoryPath() / (metrics->getBaseFileName() + ".txt");
+        if (!std::filesystem::exists(file)) return true;
+        auto rows = FileManager::read(file.string(), ';');
+        if (!rows || rows->empty()) return true;
+
+        const std::vector<std::string>& header = rows->front();
+        auto column = [&header](const std::string& name) {
+            return (int) (std::find(header.begin(), header.end(), name) - header.begin());
+        };
+        const int seedCol = column("Seed"), streamCol = column("Stream"), tempCol = column("Temperature"), alphaCol = column("Alpha");
+        if (seedCol >= (int) header.size() || streamCol >= (int) header.size()) return true;
+
+        const bool meta = job.simulation == "MetaHeuristic";
+        if (meta && (tempCol >= (int) header.size() || alphaCol >= (int) header.size())) return true;
+        const std::string seed = std::to_string(instance.seed);
+        std::set<uint64_t> streams;
+        for (size_t r = 1; r < rows->size(); ++r) {
+            const auto& row = (*rows)[r];
+            if (row.size() != header.size() || row[seedCol] != seed) continue;
+            if (meta && (row[tempCol] != utils::toString(job.temperature, 6) || row[alphaCol] != utils::toString(job.alpha, 6))) continue;
+            try {
+                streams.insert(std::stoull(row[streamCol]));
+            } catch (const std::exception&) {
+            }
+        }
+
+        if (!meta) return streams.count(0) == 0;
+        int done = 0;
+        while (done < loopTest && streams.count((uint64_t) done + 1) > 0) ++done;
+        job.firstRepetition = done;
+        return done < loopTest;
+    }
+
+    namespace {
+        /**
+         * @brief Records the lower bound the experiment asks for in the metrics of an instance.
+         */
+        inline void certify(Result& state, const Experiment& experiment) {
+            if (experiment.lowerBound == "Lagrangian") {
+                LowerBounds::certify(state);
+            } else if (experiment.lowerBound == "LP") {
+                double seconds = 0.0;
+                Profiling::ScopedTimer timer("MathModels::lpRelaxation", &seconds, "bound");
+                const std::optional<double> bound = MathModels::lpRelaxation(state, experiment.solver);
+                timer.stop();
+                if (bound) LowerBounds::record(state, "LP", *bound, seconds);
+            }
+        }
+
+        /**
+         * @brief Runs one job on a copy of its instance, as `initializeSimulation` would.
+         */
+        inline void runJob(const Result& instance, const utils::Rng& instanceRng, const Job& job, const Experiment& experiment) {
+            utils::Rng rng = instanceRng;
+            if (job.simulation == "Mathematical") {
+                Result state = instance;
+                MathModels::bootup(job.algorithm, state, rng, experiment.solver);
+            } else if (job.simulation == "Heuristic") {
+                Result state = instance;
+                Heuristics::bootup(job.algorithm, state, rng);
+            } else if (job.simulation == "Online") {
+                Online::bootup(job.algorithm, instance, experiment.onlineEvents, rng);
+            } else if (job.simulation == "MetaHeuristic") {
+                // The pool already runs one job per thread, so the chains of a job run one after another.
+                MetaHeuristics::bootup(job.algorithm, instance, job.temperature, job.alpha, job.heuristic, experiment.loopTest, rng, 1, 0, job.firstRepetition, experiment.search, experiment.tabu);
+            } else {
+                std::cerr << "Error: Unknown simulation type '" << job.simulation << "'." << std::endl;
+            }
+        }
+    }
+
+    /**
+     * @brief Runs an experiment matrix on a work-stealing thread pool.
+     * @details Every data set is pre-calculated once, which creates its data files from
+     * the data set seed. Its instances then come from `InstanceCache::global()`, as in
+     * `initializeSimulation`, and each is shared, read-only, by the jobs that run on it;
+     * each job copies it (the candidate table itself is shared), and the cache may drop
+     * it once its last job has finished. Pre-calculations run one at a time, since they may create
+     * the same data files and snapshots, and use every core internally: each data set
+     * task queues the next one before its own jobs, on its own worker, so the next data set
+     * is stolen by the first idle worker while the jobs already prepared keep the others
+     * busy. With `resume`, jobs whose rows are already
+     * in the results files are skipped, and data sets with nothing left to run are not
+     * even pre-calculated.
+     *
+     * A row can be replayed with `initializeSimulation(..., bottlenecks, heuristic, seed)`
+     * using the seed recorded in it.
+     *
+     * @param[in] experiment The matrix to run.
+     * @return `true` if every job ran without an uncaught exception.
+     */
+    inline bool run(const Experiment& experiment) {
+        const std::vector<Job> matrixJobs = jobs(experiment);
+        std::vector<DataSetPlan> plans;
+        size_t total = 0, skipped = 0;
+        for (int D : experiment.devices) {
+            for (int EC : experiment.serversEC) {
+                for (int CC : experiment.serversCC) {
+                    for (int tech : experiment.techs) {
+                        DataSetPlan plan{D, EC, CC, tech, {}};
+                        for (int flag : experiment.bottlenecks) {
+                            Instance instance{D, EC, CC, tech, flag != 0, instanceSeed(experiment, D, EC, CC, tech, flag != 0)};
+                            std::vector<Job> todo;
+                            for (Job job : matrixJobs) {
+                                ++total;
+                                if (!experiment.resume || pending(instance, job, experiment.loopTest)) todo.push_back(job);
+                                else ++skipped;
+                            }
+                            if (!todo.empty()) plan.instances.emplace_back(instance, std::move(todo));
+                        }
+                        if (!plan.instances.empty()) plans.push_back(std::move(plan));
+                    }
+                }
+            }
+        }
+
+        // Declared before the pool: its tasks call `prepare`, which must outlive the workers' join.
+        std::function<void(size_t)> prepare;
+        Parallel::WorkStealingPool pool(experiment.threads);
+        std::cout << "Experiment: " << total << " jobs on " << pool.size() << " threads, " << skipped << " already complete." << std::endl;
+
+        prepare = [&](size_t index) {
+            if (index >= plans.size()) return;
+            const DataSetPlan& plan = plans[index];
+            utils::Rng dataRng(mixSeed(experiment.seed, {plan.devices, plan.serversEC, plan.serversCC, plan.tech}));
+            const bool prepared = NetworkResourceAllocation::pre_calculation("Experiment", "Instance", plan.devices, plan.serversEC, plan.serversCC, plan.tech, dataRng).has_value();
+            pool.submit([&prepare, index]() { prepare(index + 1); });
+            if (!prepared) {
+                std::cerr << "Error: Could not prepare the data set D" << plan.devices << "_S" << plan.serversEC + plan.serversCC << "_" << plan.tech << "G." << std::endl;
+                return;
+            }
+
+            const InstanceCache::Finish finish = [&experiment](Result& state) { certify(state, experiment); };
+            for (const auto& [instance, todo] : plan.instances) {
+                // The data files exist by now, so the cached instance loads them (or their snapshot) whatever its seed.
+                const auto view = InstanceCache::global().share({instance.devices, instance.serversEC, instance.serversCC, instance.tech, instance.bottlenecks, instance.seed}, finish);
+                if (!view) continue;
+                for (const Job& job : todo) {
+                    pool.submit([view, job, &experiment]() { runJob(view->state, view->rng, job, experiment); });
+                }
+            }
+        };
+        pool.submit([&prepare]() { prepare(0); });
+
+        bool ok = true;
+        try {
+            pool.wait();
+        } catch (const std::exception& e) {
+            std::cerr << "Error: An experiment job failed: " << e.what() << std::endl;
+            ok = false;
+        }
+        ResultsSink::global().flush();
+        return ok;
+    }
+}
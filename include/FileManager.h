@@ -1,15 +1,158 @@
 #pragma once
 
+#include <charconv>
 #include <fstream>
 #include <filesystem>
 #include <iostream>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FILEMANAGER_HAS_MMAP 1
+#endif
+
 namespace FileManager {
 
+    /**
+     * @class MappedFile
+     * @brief Read-only view of a whole file, memory-mapped where the platform allows it.
+     * @details On POSIX systems the file is mapped with `mmap`, so parsing it never copies
+     * the bytes into intermediate strings. Elsewhere (or if mapping fails) the file is
+     * read once into an owned buffer. The content is available through `view()` for the
+     * lifetime of the object.
+     */
+    class MappedFile {
+    public:
+        /**
+         * @brief Opens and maps a file.
+         * @param[in] filePath The full path to the file to map. On failure an error is
+         * logged to std::cerr and `isOpen()` returns false.
+         */
+        explicit MappedFile(const std::string& filePath) {
+#ifdef FILEMANAGER_HAS_MMAP
+            int fd = ::open(filePath.c_str(), O_RDONLY);
+            if (fd >= 0) {
+                struct stat st;
+                if (::fstat(fd, &st) == 0) {
+                    length = static_cast<size_t>(st.st_size);
+                    opened = true;
+                    if (length > 0) {
+                        void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                        if (addr != MAP_FAILED) {
+                            mapped = static_cast<const char*>(addr);
+#ifdef MADV_SEQUENTIAL
+                            ::madvise(addr, length, MADV_SEQUENTIAL);
+#endif
+                        }
+                    }
+                }
+                ::close(fd);
+                if (mapped || (opened && length == 0)) return;
+                opened = false;
+            }
+#endif
+            std::ifstream file(filePath, std::ios::binary);
+            if (!file.is_open()) {
+                std::cerr << "Error: Could not open file " << filePath << std::endl;
+                return;
+            }
+            buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            length = buffer.size();
+            opened = true;
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() {
+#ifdef FILEMANAGER_HAS_MMAP
+            if (mapped) ::munmap(const_cast<char*>(mapped), length);
+#endif
+        }
+
+        inline bool isOpen() const { return opened; }
+        inline std::string_view view() const { return mapped ? std::string_view(mapped, length) : std::string_view(buffer); }
+
+    private:
+        const char* mapped = nullptr;
+        size_t length = 0;
+        bool opened = false;
+        std::string buffer;
+    };
+
+    /**
+     * @class FieldCursor
+     * @brief Walks the rows and whitespace-separated fields of a text buffer in place.
+     * @details Fields are converted with `std::from_chars` straight from the buffer, so no
+     * string is allocated per cell. Like `std::stoi`/`std::stod`, a conversion consumes the
+     * longest valid prefix of the field and ignores the rest (e.g. "96.0" read as an int is 96).
+     */
+    class FieldCursor {
+    public:
+        explicit FieldCursor(std::string_view text) : pos(text.data()), end(text.data() + text.size()) {}
+
+        /**
+         * @brief Moves to the first field of the next non-empty line.
+         * @return `false` once the buffer is exhausted.
+         */
+        inline bool nextRow() {
+            while (pos < end) {
+                skipBlanks();
+                if (pos < end && *pos != '\n') return true;
+                if (pos < end) ++pos;
+            }
+            return false;
+        }
+
+        /**
+         * @brief Returns the next field of the current line without converting it.
+         * @return The field, or an empty view if the line has no more fields.
+         */
+        inline std::string_view field() {
+            skipBlanks();
+            const char* first = pos;
+            while (pos < end && !isBlank(*pos) && *pos != '\n') ++pos;
+            return std::string_view(first, pos - first);
+        }
+
+        /**
+         * @brief Converts the next field of the current line.
+         * @tparam T An arithmetic type supported by `std::from_chars`.
+         * @param[out] value The parsed value.
+         * @return `true` on success, `false` if the field is missing or not a number.
+         */
+        template <typename T>
+        inline bool next(T& value) {
+            std::string_view f = field();
+            if (f.empty()) return false;
+            const char* first = f.data();
+            if (*first == '+') ++first; // accepted by stod/stoi, rejected by from_chars
+            return std::from_chars(first, f.data() + f.size(), value).ec == std::errc();
+        }
+
+        /**
+         * @brief Skips whatever remains of the current line, including the line break.
+         */
+        inline void skipLine() {
+            while (pos < end && *pos != '\n') ++pos;
+            if (pos < end) ++pos;
+        }
+
+    private:
+        const char* pos;
+        const char* end;
+
+        static inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+        inline void skipBlanks() { while (pos < end && isBlank(*pos)) ++pos; }
+    };
+
     /**
      * @brief Reads a delimited text file into a 2D vector of strings.
      * @details This function opens and parses a file line by line. Each line is split
@@ -2,6 +2,8 @@
 
 #include "NetworkResourceAllocation.h"
 
+#include <functional>
+
 namespace Heuristics {
     namespace {
         /**
@@ -13,124 +15,406 @@ namespace Heuristics {
          *
          * @param[in,out] state A reference to the Result object. It provides the initial
          * state and is updated in-place with the allocation results and calculated metrics.
+         * @param[in,out] rng The random number context to draw from.
          */
-        inline void randomHeuristic(Result& state) {
+        inline void randomHeuristic(Result& state, utils::Rng& rng) {
             Devices& devices = state.devices;
-            Servers& servers = state.servers;
+            CapacityLedger& ledger = state.ledger;
+            const CandidateTable& candidates = *state.candidates;
             iVec coveredDevicesIdx = state.coveredDevicesIdx;
 
-            auto startChrono = std::chrono::high_resolution_clock::now();
+            Profiling::ScopedTimer timer("randomHeuristic", &state.metrics->outputs.execution_time_sec, "heuristic");
             
-            std::shuffle(coveredDevicesIdx.begin(), coveredDevicesIdx.end(), utils::getEngine());
+            utils::shuffle(rng, coveredDevicesIdx.begin(), coveredDevicesIdx.end());
             
             for (const auto& d_idx : coveredDevicesIdx) {
-                Device& device = devices.at(d_idx);
-                if (device.servers.empty()) continue;
+                Device& device = devices[d_idx];
+                const int count = candidates.count(d_idx);
+                if (count == 0) continue;
                 
-                int s_idx = utils::randomNumber(0, (int)device.servers.size());
-                if (s_idx == device.servers.size()) continue; // rejects the device
+                int s_idx = utils::randomNumber(rng, 0, count);
+                if (s_idx == count) continue; // rejects the device
                 
-                server_covering& potential_server = device.servers.at(s_idx);
-                Server& server = servers.at(potential_server.id);
+                server_covering potential_server = candidates.entry(d_idx, candidates.first(d_idx) + s_idx);
                 
-                if (server.canServe(device)) {
-                    server.addServed(device);
-                    device.server = potential_server;
+                if (ledger.canServe(potential_server.id, device)) {
+                    NetworkResourceAllocation::assign(state, device, potential_server);
                 }
             }
             
-            auto endChrono = std::chrono::high_resolution_clock::now();
-            state.metrics->outputs.execution_time_sec += std::chrono::duration<double>(endChrono - startChrono).count();
+            timer.stop();
 
-            NetworkResourceAllocation::calculateMetrics(devices, servers, *state.metrics);
+            NetworkResourceAllocation::calculateMetrics(state, *state.metrics);
         }
         
         /**
          * @brief A greedy heuristic that allocates devices based on sorted criteria.
          * @details This algorithm first sorts the list of covered devices based on their
          * cost of non-service (cnd). It then iterates through this sorted list. For each
-         * device, it sorts its list of potential servers by response time. Finally, it
+         * device, it sorts a local copy of its candidate slots by response time (the shared
+         * candidate table is never reordered). Finally, it
          * attempts to allocate the device to the first server in the sorted list that
          * has enough capacity. Once an allocation is made, it moves to the next device.
          *
-         * @param[in,out] state A reference to the Result object, which is updated
-         * in-place with the greedy allocation and final metrics.
-         * @param[in] sortDevicesAsc If true, sorts devices by CND in ascending order;
+         * Both orders are template parameters, so each of the four variants is compiled
+         * with its own comparators and the per-device loop carries no direction flag.
+         *
+         * @tparam SortDevicesAsc If true, sorts devices by CND in ascending order;
          * otherwise, sorts in descending order.
-         * @param[in] sortServersAsc If true, sorts servers by response time in
+         * @tparam SortServersAsc If true, sorts servers by response time in
          * ascending order (best first); otherwise, descending.
+         * @param[in,out] state A reference to the Result object, which is updated
+         * in-place with the greedy allocation and final metrics.
          */
-        inline void greedyHeuristic(Result& state, bool sortDevicesAsc, bool sortServersAsc) {
+        template <bool SortDevicesAsc, bool SortServersAsc>
+        inline void greedyHeuristic(Result& state) {
             Devices& devices = state.devices;
-            Servers& servers = state.servers;
+            CapacityLedger& ledger = state.ledger;
+            const CandidateTable& candidates = *state.candidates;
+            iVec slots;
+            std::vector<double> rt;
 
-            auto startChrono = std::chrono::high_resolution_clock::now();
+            Profiling::ScopedTimer timer("greedyHeuristic", &state.metrics->outputs.execution_time_sec, "heuristic");
             
-            iVec sortedCoveredIdx;
-            if (sortDevicesAsc) {
-                sortedCoveredIdx = utils::sortEntities<true, Device, const double, &Device::cnd>(devices, state.coveredDevicesIdx);
-            } else {
-                sortedCoveredIdx = utils::sortEntities<false, Device, const double, &Device::cnd>(devices, state.coveredDevicesIdx);
-            }
+            const iVec sortedCoveredIdx = utils::sortEntities<SortDevicesAsc, Device, const Real, &Device::cnd>(devices, state.coveredDevicesIdx);
 
             for (const auto& d_idx : sortedCoveredIdx) {
-                Device& device = devices.at(d_idx);
-                if (sortServersAsc) {
-                    std::sort(device.servers.begin(), device.servers.end(), [](const server_covering& a, const server_covering& b) {
-                        return a.responseTime < b.responseTime;
-                    });
-                } else {
-                    std::sort(device.servers.begin(), device.servers.end(), [](const server_covering& a, const server_covering& b) {
-                        return a.responseTime > b.responseTime;
-                    });
-                }
+                Device& device = devices[d_idx];
+                slots.resize(candidates.count(d_idx));
+                std::iota(slots.begin(), slots.end(), candidates.first(d_idx));
+                // The cloud times are derived once per device, not once per comparison.
+                const int base = candidates.first(d_idx);
+                rt.resize(slots.size());
+                for (int slot : slots) rt[slot - base] = candidates.responseTime(d_idx, slot);
+                // Stable, so equal times keep the table order (edge servers, then cloud servers).
+                std::stable_sort(slots.begin(), slots.end(), [&rt, base](int a, int b) {
+                    if constexpr (SortServersAsc) {
+                        return rt[a - base] < rt[b - base];
+                    } else {
+                        return rt[a - base] > rt[b - base];
+                    }
+                });
                 
-                for (const auto& potential_server : device.servers) {
-                    Server& server = servers.at(potential_server.id);
-                    
-                    if (server.canServe(device)) {
-                        server.addServed(device);
-                        device.server = potential_server;   
+                for (int slot : slots) {
+                    if (ledger.canServe(candidates.serverIds[slot], device)) {
+                        NetworkResourceAllocation::assign(state, device, candidates.entry(d_idx, slot));
                         break; 
                     }
                 }
             }
             
-            auto endChrono = std::chrono::high_resolution_clock::now();
-            state.metrics->outputs.execution_time_sec += std::chrono::duration<double>(endChrono - startChrono).count();
+            timer.stop();
+
+            NetworkResourceAllocation::calculateMetrics(state, *state.metrics);
+        }
+
+        /// Priority of a waiting device: compared first on the primary value, then on the secondary one.
+        using Priority = std::pair<double, double>;
+
+        /**
+         * @brief The largest share of a server's residual capacity a device would take.
+         * @details Taken over the five resource lanes (PCC, PCN, MEM, STO, BW); a lane the
+         * device does not use counts as 0. Only meaningful when the device fits.
+         */
+        inline double residualShare(const CapacityLedger& ledger, int j, const Device& device) {
+            auto part = [](double need, double left) { return need > 0.0 ? need / left : 0.0; };
+            return std::max({part(device.pcc, ledger.pcc[j]), part(device.pcn, ledger.pcn[j]), part(device.mem, ledger.mem[j]),
+                             part(device.sto, ledger.sto[j]), part(device.bw, ledger.bw[j])});
+        }
+
+        /**
+         * @brief How much room a server would have left after taking a device (lower is a tighter fit).
+         * @details The squared norm of the residual capacity after the allocation, each lane
+         * normalised by the server's full capacity, as in vector bin packing.
+         */
+        inline double leftover(const CapacityLedger& ledger, const Server& server, int j, const Device& device) {
+            auto lane = [](double left, double need, double capacity) {
+                const double r = capacity > 0.0 ? (left - need) / capacity : 0.0;
+                return r * r;
+            };
+            return lane(ledger.pcc[j], device.pcc, server.pcc_total) + lane(ledger.pcn[j], device.pcn, server.pcn) +
+                   lane(ledger.mem[j], device.mem, server.mem) + lane(ledger.sto[j], device.sto, server.sto) +
+                   lane(ledger.bw[j], device.bw, server.bw);
+        }
+
+        /**
+         * @brief The feasible slot of a device with the lowest increase in cost, ties broken by the tightest fit.
+         * @return The candidate slot, or -1 if the device fits on none of its servers.
+         */
+        inline int cheapestTightestSlot(const Result& state, int d) {
+            const CandidateTable& candidates = *state.candidates;
+            const Device& device = state.devices[d];
+            int best = -1;
+            double bestCost = 0.0, bestLeftover = 0.0;
+            for (int slot = candidates.first(d); slot < candidates.last(d); ++slot) {
+                const int j = candidates.serverIds[slot];
+                if (!state.ledger.canServe(j, device)) continue;
+                const double cost = state.servers[j].on ? 0.0 : state.servers[j].csc;
+                const double room = leftover(state.ledger, state.servers[j], j, device);
+                if (best < 0 || cost < bestCost || (cost == bestCost && room < bestLeftover)) {
+                    best = slot;
+                    bestCost = cost;
+                    bestLeftover = room;
+                }
+            }
+            return best;
+        }
+
+        /**
+         * @brief Allocates the covered devices one at a time, in order of a priority that changes as servers fill.
+         * @details The waiting devices sit in an indexed max-priority queue. Priorities are
+         * refreshed lazily: the device on top is re-evaluated before it is placed and, if
+         * its priority changed, re-queued with the new value. When a device is placed on an
+         * edge server, the waiting devices that have that server among their candidates
+         * (few, since edge coverage is local) are re-evaluated at once; cloud servers,
+         * candidates of every device, rely on the lazy refresh only. A device that fits
+         * nowhere leaves the queue and stays unserved.
+         *
+         * @param[in,out] state The state to allocate in place.
+         * @param[in] priority Returns the priority of a waiting device, or `std::nullopt` if it fits nowhere.
+         * @param[in] choose Returns the slot a device is placed on (one that fits).
+         */
+        template <typename PriorityFn, typename ChooseFn>
+        inline void priorityFill(Result& state, PriorityFn priority, ChooseFn choose) {
+            const CandidateTable& candidates = *state.candidates;
+            std::vector<iVec> byEdge(state.servers.size());
+            utils::IndexedPriorityQueue<Priority> queue(state.devices.size());
+            for (int d : state.coveredDevicesIdx) {
+                if (state.devices[d].served) continue;
+                for (int slot = candidates.first(d); slot < candidates.last(d); ++slot) {
+                    if (state.servers[candidates.serverIds[slot]].type == 'E') byEdge[candidates.serverIds[slot]].push_back(d);
+                }
+                if (auto key = priority(d)) queue.update(d, *key);
+            }
+
+            auto refresh = [&](int d) {
+                if (auto key = priority(d)) queue.update(d, *key);
+                else queue.erase(d);
+            };
+
+            while (!queue.empty()) {
+                const int d = queue.top();
+                const std::optional<Priority> key = priority(d);
+                if (!key || *key != queue.key(d)) {
+                    refresh(d);
+                    continue;
+                }
+                queue.erase(d);
+
+                const int slot = choose(d);
+                if (slot < 0) continue;
+                const int j = candidates.serverIds[slot];
+                NetworkResourceAllocation::assign(state, state.devices[d], candidates.entry(d, slot));
+                if (state.servers[j].type == 'E') {
+                    for (int other : byEdge[j]) {
+                        if (queue.contains(other)) refresh(other);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief The Regret-k heuristic: the device that would lose most by waiting is placed first.
+         * @details The value of an option is the device's CND minus the cost of switching its
+         * server on (0 if it is already on); leaving the device unserved is worth 0 and
+         * stands in for missing options. The regret of a device is the sum, over its 2nd
+         * to k-th best feasible options, of how much worse they are than the best one, so
+         * devices about to run out of servers rise to the top. Ties are broken by higher
+         * CND. Each device is placed on its cheapest feasible server, the tightest fit
+         * among equally cheap ones.
+         *
+         * @param[in,out] state The Result object, updated in-place with the allocation and final metrics.
+         * @param[in] k The number of options compared (at least 2).
+         */
+        inline void regretHeuristic(Result& state, int k) {
+            Profiling::ScopedTimer timer("regretHeuristic", &state.metrics->outputs.execution_time_sec, "heuristic");
+            const CandidateTable& candidates = *state.candidates;
+            std::vector<double> values;
+
+            auto priority = [&](int d) -> std::optional<Priority> {
+                const Device& device = state.devices[d];
+                values.clear();
+                for (int slot = candidates.first(d); slot < candidates.last(d); ++slot) {
+                    const int j = candidates.serverIds[slot];
+                    if (state.ledger.canServe(j, device)) values.push_back(device.cnd - (state.servers[j].on ? 0.0 : state.servers[j].csc));
+                }
+                if (values.empty()) return std::nullopt;
+                const size_t options = std::min<size_t>(values.size(), k);
+                std::partial_sort(values.begin(), values.begin() + options, values.end(), std::greater<double>());
+                double regret = 0.0;
+                for (int i = 1; i < k; ++i) regret += values[0] - (i < (int) options ? values[i] : 0.0);
+                return Priority{regret, device.cnd};
+            };
+            priorityFill(state, priority, [&state](int d) { return cheapestTightestSlot(state, d); });
+
+            timer.stop();
+
+            NetworkResourceAllocation::calculateMetrics(state, *state.metrics);
+        }
+
+        /**
+         * @brief A multi-resource best-fit heuristic (vector bin packing over PCC, PCN, MEM, STO and BW).
+         * @details Devices are placed by decreasing density: CND per share of capacity they
+         * would take on the roomiest server that still fits them (`residualShare`), so
+         * valuable, small devices go first. The density only falls as servers fill, which
+         * makes the lazy refresh of `priorityFill` exact. Each device goes to an
+         * already active server when one fits, then to the cheapest one to switch on, and
+         * among those to the tightest fit (`leftover`).
+         *
+         * @param[in,out] state The Result object, updated in-place with the allocation and final metrics.
+         */
+        inline void bestFitHeuristic(Result& state) {
+            Profiling::ScopedTimer timer("bestFitHeuristic", &state.metrics->outputs.execution_time_sec, "heuristic");
+            const CandidateTable& candidates = *state.candidates;
+
+            auto priority = [&](int d) -> std::optional<Priority> {
+                const Device& device = state.devices[d];
+                double share = 0.0;
+                bool fits = false;
+                for (int slot = candidates.first(d); slot < candidates.last(d); ++slot) {
+                    const int j = candidates.serverIds[slot];
+                    if (!state.ledger.canServe(j, device)) continue;
+                    const double s = residualShare(state.ledger, j, device);
+                    if (!fits || s < share) share = s;
+                    fits = true;
+                }
+                if (!fits) return std::nullopt;
+                return Priority{device.cnd / std::max(share, 1e-12), device.cnd};
+            };
+            priorityFill(state, priority, [&state](int d) { return cheapestTightestSlot(state, d); });
+
+            timer.stop();
 
-            NetworkResourceAllocation::calculateMetrics(devices, servers, *state.metrics);
+            NetworkResourceAllocation::calculateMetrics(state, *state.metrics);
         }
     }
     
     /**
-     * @brief Serves as the main entry point for running a specific heuristic algorithm.
-     * @details This function acts as a dispatcher. It parses the `algorithm` string to
-     * determine which heuristic to execute. For "Greedy" variants, it also parses the
-     * name to set the sorting direction for both devices and servers before invoking
-     * the `greedyHeuristic` function. After the heuristic runs, it finalizes,
-     * displays, and saves the resulting metrics.
+     * @brief A heuristic resolved from its name: the kernel to call and its parameter.
+     */
+    struct Algorithm {
+        void (*kernel)(Result&, utils::Rng&, int) = nullptr;
+        int k = 0; ///< The parameter of parametrised heuristics (the k of Regret-k).
+    };
+
+    namespace {
+        struct NamedKernel {
+            const char* name;
+            void (*kernel)(Result&, utils::Rng&, int);
+        };
+
+        /// The heuristics selected by their exact name; "Regret_k" is parsed by `resolve`.
+        const NamedKernel KERNELS[] = {
+            {"Random", [](Result& state, utils::Rng& rng, int) { randomHeuristic(state, rng); }},
+            {"Greedy_AscAsc", [](Result& state, utils::Rng&, int) { greedyHeuristic<true, true>(state); }},
+            {"Greedy_AscDesc", [](Result& state, utils::Rng&, int) { greedyHeuristic<true, false>(state); }},
+            {"Greedy_DescAsc", [](Result& state, utils::Rng&, int) { greedyHeuristic<false, true>(state); }},
+            {"Greedy_DescDesc", [](Result& state, utils::Rng&, int) { greedyHeuristic<false, false>(state); }},
+            {"BestFit", [](Result& state, utils::Rng&, int) { bestFitHeuristic(state); }},
+        };
+
+        inline void regretKernel(Result& state, utils::Rng&, int k) { regretHeuristic(state, k); }
+    }
+
+    /**
+     * @brief The names of the registered heuristics: every named kernel, then "Regret" (Regret-2).
+     * @details Other Regret-k variants are accepted by `resolve` as "Regret_k".
+     */
+    inline std::vector<std::string> names() {
+        std::vector<std::string> list;
+        for (const NamedKernel& entry : KERNELS) list.push_back(entry.name);
+        list.push_back("Regret");
+        return list;
+    }
+
+    /**
+     * @brief Resolves a heuristic name into its kernel, once, so repeated runs skip the string comparisons.
+     * @details "Regret" is Regret-2 and "Regret_k" Regret-k. Any other "Greedy" name
+     * sorts both lists in descending order, as the four named variants did when their
+     * directions were parsed from the name.
      *
-     * @param[in] algorithm The specific algorithm name (e.g., "Random", "Greedy_DescAsc").
-     * @param[in,out] state The Result object containing the initial simulation state, which will
-     * be modified by the selected heuristic.
+     * @param[in] algorithm The specific algorithm name (e.g., "Random", "Greedy_DescAsc", "Regret_3", "BestFit").
+     * @return The resolved heuristic, or `std::nullopt` if the name is unknown (an error is logged).
      */
-    inline void bootup(const std::string& algorithm, Result& state) {
-        if (algorithm == "Random") {
-            randomHeuristic(state);
-        } else if (algorithm.rfind("Greedy", 0) == 0) {
-            bool sortDevicesAsc = (algorithm == "Greedy_AscAsc" || algorithm == "Greedy_AscDesc");
-            bool sortServersAsc = (algorithm == "Greedy_AscAsc" || algorithm == "Greedy_DescAsc");
-            greedyHeuristic(state, sortDevicesAsc, sortServersAsc);
-        } else {
-            std::cerr << "Error: Unknown heuristic algorithm type." << std::endl;
-            return;
+    inline std::optional<Algorithm> resolve(const std::string& algorithm) {
+        for (const NamedKernel& entry : KERNELS) {
+            if (algorithm == entry.name) return Algorithm{entry.kernel, 0};
+        }
+        if (algorithm == "Regret" || algorithm.rfind("Regret_", 0) == 0) {
+            int k = 2;
+            if (algorithm != "Regret") {
+                const char* first = algorithm.data() + 7;
+                const char* last = algorithm.data() + algorithm.size();
+                if (std::from_chars(first, last, k).ptr != last || k < 2) {
+                    std::cerr << "Error: Invalid Regret-k heuristic '" << algorithm << "'." << std::endl;
+                    return std::nullopt;
+                }
+            }
+            return Algorithm{regretKernel, k};
+        }
+        if (algorithm.rfind("Greedy", 0) == 0) {
+            return Algorithm{[](Result& state, utils::Rng&, int) { greedyHeuristic<false, false>(state); }, 0};
         }
+        std::cerr << "Error: Unknown heuristic algorithm type." << std::endl;
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Runs a resolved heuristic on a state without displaying or saving its metrics.
+     * @details Having no side effects outside `state`, it is safe to call concurrently on
+     * independent states.
+     *
+     * @param[in] algorithm The heuristic returned by `resolve`.
+     * @param[in,out] state The Result object to allocate in-place.
+     * @param[in,out] rng The random number context used by randomized heuristics.
+     */
+    inline void run(const Algorithm& algorithm, Result& state, utils::Rng& rng) {
+        algorithm.kernel(state, rng, algorithm.k);
+    }
+
+    /**
+     * @brief Runs a heuristic on a state without displaying or saving its metrics.
+     * @details Resolves `algorithm` (see `resolve`) and runs it. Callers that run the
+     * same heuristic many times resolve it once and call the `Algorithm` overload.
+     *
+     * @param[in] algorithm The specific algorithm name (e.g., "Random", "Greedy_DescAsc", "Regret_3", "BestFit").
+     * @param[in,out] state The Result object to allocate in-place.
+     * @param[in,out] rng The random number context used by randomized heuristics.
+     * @return `true` if the algorithm name is known and the heuristic ran, `false` otherwise.
+     */
+    inline bool run(const std::string& algorithm, Result& state, utils::Rng& rng) {
+        const std::optional<Algorithm> resolved = resolve(algorithm);
+        if (!resolved) return false;
+        run(*resolved, state, rng);
+        return true;
+    }
 
-        if (state.metrics) {
-            auto metrics = std::make_unique<HeuristicMetrics>("Heuristic", algorithm, state.metrics);
-            showStructs::showMetrics(*metrics);
-            metrics->saveResultsToFile(); // Use the final server count
+    /**
+     * @brief Displays and saves the metrics of a state produced by `run`.
+     * @param[in] algorithm The heuristic algorithm name the state was produced with.
+     * @param[in] metrics The final metrics of that state.
+     */
+    inline void report(const std::string& algorithm, const std::unique_ptr<Metrics>& metrics) {
+        if (metrics) {
+            auto heuristicMetrics = std::make_unique<HeuristicMetrics>("Heuristic", algorithm, metrics);
+            showStructs::showMetrics(*heuristicMetrics);
+            heuristicMetrics->saveResultsToFile(); // Use the final server count
         }
     }
+    
+    /**
+     * @brief Serves as the main entry point for running a specific heuristic algorithm.
+     * @details This function acts as a dispatcher. It runs the heuristic selected by
+     * `algorithm` through `run` and then finalizes, displays, and saves the resulting
+     * metrics.
+     *
+     * @param[in] algorithm The specific algorithm name (e.g., "Random", "Greedy_DescAsc", "Regret_2", "BestFit").
+     * @param[in,out] state The Result object containing the initial simulation state, which will
+     * be modified by the selected heuristic.
+     * @param[in,out] rng The random number context used by randomized heuristics.
+     */
+    inline void bootup(const std::string& algorithm, Result& state, utils::Rng& rng) {
+        if (!run(algorithm, state, rng)) return;
+        report(algorithm, state.metrics);
+    }
 }
\ No newline at end of file
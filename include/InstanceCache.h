@@ -0,0 +1,172 @@
+#pragma once
+
+#include "NetworkResourceAllocation.h"
+#include "structs.h"
+#include "utils.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+
+/**
+ * @class InstanceCache
+ * @brief Prepares each problem instance once and hands every algorithm its own copy.
+ * @details An instance is identified by its sizes, technology, bottleneck flag and seed.
+ * The first request runs `pre_calculation` (and `createBottleneck`) with `Rng(seed)`
+ * and keeps the prepared state together with a fresh `Rng(seed)` for the algorithms.
+ * The data generation only draws from its context when the data files are missing, so
+ * the algorithms must not continue that stream: they would then draw differently on the
+ * run that created the files and on the runs that loaded them (or their snapshot), and
+ * the recorded seed would not replay the run. Later requests get a copy of both, so
+ * algorithms compared on the same key see the very same devices, servers, bottleneck
+ * and random stream, and pay the preparation only once.
+ *
+ * A view shares the immutable candidate table with the cached instance and copies the
+ * state an algorithm writes (devices, servers, ledger, tracker, metrics); these are
+ * flat vectors of plain structs, so the copy is a few `memcpy`s. Callers that only read
+ * the instance, such as `ExperimentRunner`, hold the cached view itself through `share`.
+ * All member functions are thread-safe; concurrent first requests are prepared one at a time.
+ *
+ * The cache keeps at most `capacity` instances: when it grows past it, the least
+ * recently used instances that no caller holds any more are dropped. Instances still
+ * held are never dropped, so the cache may exceed its capacity while they are in use.
+ */
+class InstanceCache {
+public:
+    struct Key {
+        int devices = 0;
+        int serversEC = 0;
+        int serversCC = 0;
+        int tech = 0;
+        bool bottlenecks = false;
+        uint64_t seed = 0;
+
+        inline bool operator<(const Key& other) const {
+            return std::tie(devices, serversEC, serversCC, tech, bottlenecks, seed)
+                 < std::tie(other.devices, other.serversEC, other.serversCC, other.tech, other.bottlenecks, other.seed);
+        }
+    };
+
+    /**
+     * @struct View
+     * @brief A private copy of a cached instance, ready for one algorithm.
+     */
+    struct View {
+        Result state;
+        utils::Rng rng; ///< The random context of the algorithms, `Rng(seed)` whatever the preparation drew.
+    };
+
+    /**
+     * @brief The cache shared by the simulation drivers.
+     */
+    static inline InstanceCache& global() {
+        static InstanceCache cache;
+        return cache;
+    }
+
+    /// A last step run on a freshly prepared instance before it is cached (e.g., computing its lower bound).
+    using Finish = std::function<void(Result&)>;
+
+    /**
+     * @param[in] capacity The number of instances kept once no caller holds them (0 keeps every instance).
+     */
+    explicit InstanceCache(size_t capacity = 4) : capacity(capacity) {}
+    InstanceCache(const InstanceCache&) = delete;
+    InstanceCache& operator=(const InstanceCache&) = delete;
+
+    /**
+     * @brief Returns the cached view of the instance, preparing it on first use.
+     * @details The view is shared and read-only; it stays cached at least as long as
+     * the returned pointer is held.
+     * @param[in] key The instance to prepare or reuse.
+     * @param[in] finish Run once on the prepared state, before it is cached; later
+     * requests for the same key get the finished state whatever they pass.
+     * @return The view, or `nullptr` if the pre-calculation failed (an error is logged).
+     */
+    inline std::shared_ptr<const View> share(const Key& key, const Finish& finish = nullptr) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = instances.find(key);
+        if (it == instances.end()) {
+            utils::Rng rng(key.seed);
+            auto state = NetworkResourceAllocation::pre_calculation("Instance", "Cache", key.devices, key.serversEC, key.serversCC, key.tech, rng);
+            if (!state) return nullptr;
+            if (key.bottlenecks) NetworkResourceAllocation::createBottleneck(state, rng, false);
+            if (finish) finish(*state);
+            it = instances.emplace(key, Entry{std::make_shared<const View>(View{std::move(*state), utils::Rng(key.seed)}), 0}).first;
+        }
+        it->second.lastUse = ++clock;
+        std::shared_ptr<const View> view = it->second.view;
+        evict();
+        return view;
+    }
+
+    /**
+     * @brief Returns a private copy of the instance, preparing it on first use.
+     * @param[in] key The instance to prepare or reuse.
+     * @param[in] finish See `share`.
+     * @return The view, or `std::nullopt` if the pre-calculation failed (an error is logged).
+     */
+    inline std::optional<View> acquire(const Key& key, const Finish& finish = nullptr) {
+        const std::shared_ptr<const View> view = share(key, finish);
+        if (!view) return std::nullopt;
+        return *view;
+    }
+
+    /**
+     * @brief Changes the number of instances kept once no caller holds them (0 keeps every instance).
+     */
+    inline void setCapacity(size_t instancesKept) {
+        std::lock_guard<std::mutex> lock(mutex);
+        capacity = instancesKept;
+        evict();
+    }
+
+    /**
+     * @brief Drops one instance; later requests prepare it again.
+     */
+    inline void release(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        instances.erase(key);
+    }
+
+    /**
+     * @brief Drops every instance.
+     */
+    inline void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        instances.clear();
+    }
+
+    inline size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return instances.size();
+    }
+
+private:
+    struct Entry {
+        std::shared_ptr<const View> view;
+        uint64_t lastUse = 0; ///< Value of `clock` when the instance was last requested.
+    };
+
+    std::mutex mutex;
+    std::map<Key, Entry> instances;
+    size_t capacity;
+    uint64_t clock = 0;
+
+    /// Drops the least recently used unheld instances until the cache fits its capacity; the mutex must be held.
+    inline void evict() {
+        while (capacity > 0 && instances.size() > capacity) {
+            // References are only taken under the mutex, so a count of one cannot grow meanwhile.
+            auto victim = instances.end();
+            for (auto it = instances.begin(); it != instances.end(); ++it) {
+                if (it->second.view.use_count() == 1 && (victim == instances.end() || it->second.lastUse < victim->second.lastUse)) victim = it;
+            }
+            if (victim == instances.end()) return;
+            instances.erase(victim);
+        }
+    }
+};
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "Decomposition.h"
+#include "Heuristics.h"
+#include "NetworkResourceAllocation.h"
+#include "Profiling.h"
+#include "structs.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+/**
+ * @namespace LowerBounds
+ * @brief Lower bounds on the cost of an instance, to certify heuristic solutions without the MIP.
+ * @details `lagrangian` relaxes the capacity rows of the `Minimize_Cost` model,
+ * \f$\sum_d r_d x_i^d \le R_i z_i\f$ for the five lanes (PCC, PCN, MEM, STO, BW), with
+ * one multiplier \f$\lambda_{ir} \ge 0\f$ per server and lane. Read as a price per unit
+ * of capacity, \f$\lambda_{ir} / R_{ir}\f$, the relaxed problem falls apart: each
+ * server opens if its prices add up to more than its activation cost and each device
+ * takes its cheapest priced slot, or stays unserved if its `cnd` is lower. Any
+ * \f$\lambda\f$ thus gives a bound in one pass over the candidate table, and a
+ * deflected subgradient search with Polyak steps raises it towards the bound of the LP
+ * relaxation (without the x <= z rows). Slots where a device does not fit an empty
+ * server on some lane are left out, which only tightens the bound.
+ *
+ * The LP relaxation itself, solved by CPLEX, is `MathModels::lpRelaxation`.
+ */
+namespace LowerBounds {
+
+    /**
+     * @struct Options
+     * @brief The stopping rule and step schedule of the subgradient search.
+     * @details The search runs two rounds from the same initial factor. Lower factors
+     * (0.5 or 1) avoid the early divergence on nearly empty instances, but reach
+     * noticeably weaker bounds on loaded ones; the second round covers the former.
+     */
+    struct Options {
+        int iterations = 1500;    ///< Largest number of subgradient steps of each round.
+        int stall = 40;           ///< Steps without a better bound before the step factor is halved.
+        double step = 2.0;        ///< Initial Polyak step factor.
+        double deflection = 0.5;  ///< Share of the previous direction added to each subgradient.
+        double tolerance = 1e-4;  ///< Relative distance to the upper bound at which the search stops.
+        double upperBound = 0.0;  ///< Cost of a feasible allocation, the Polyak target (0: that of "BestFit").
+    };
+
+    /**
+     * @struct Bound
+     * @brief The outcome of a subgradient search, in model objective units (non-service + servers used).
+     */
+    struct Bound {
+        double value = 0.0;      ///< The best Lagrangian bound found.
+        double upperBound = 0.0; ///< The feasible cost the steps aimed at.
+        int iterations = 0;      ///< Subgradient steps taken.
+    };
+
+    namespace {
+        constexpr int LANES = 5;
+
+        /// Cost of the allocation "BestFit" finds on a copy of the state.
+        inline double bestFitCost(const Result& state) {
+            Result copy(state);
+            utils::Rng rng(0);
+            if (!Heuristics::run("BestFit", copy, rng)) return 0.0;
+            return copy.tracker.allocationCost();
+        }
+    }
+
+    /**
+     * @brief Computes the Lagrangian bound of the capacity rows by subgradient optimization.
+     * @details A first round follows the Polyak steps wherever they lead; a second one
+     * starts from the best multipliers and falls back to them each time the step factor
+     * is halved. The bound is the best one either round reached.
+     * @param[in] state The pre-calculated state; it is not modified.
+     * @param[in] options The stopping rule and step schedule.
+     * @return The bound on the allocation cost (non-service + servers used) of every feasible solution.
+     */
+    inline Bound lagrangian(const Result& state, Options options = {}) {
+        const Devices& devices = state.devices;
+        const Servers& servers = state.servers;
+        const CandidateTable& candidates = *state.candidates;
+        const size_t numServers = servers.size();
+
+        Bound bound;
+        double trivial = 0.0;
+        for (int d_idx : state.coveredDevicesIdx) trivial += devices[d_idx].cnd;
+        bound.upperBound = options.upperBound > 0.0 ? options.upperBound : bestFitCost(state);
+        if (bound.upperBound <= 0.0) bound.upperBound = trivial;
+        if (bound.upperBound <= 0.0) return bound;
+
+        std::vector<Decomposition::Lanes> capacity(numServers);
+        for (size_t i = 1; i < numServers; ++i) capacity[i] = Decomposition::capacity(servers[i]);
+
+        // A slot is usable only if the device fits the empty server on every lane.
+        std::vector<char> fits(candidates.size(), 0);
+        for (int d_idx : state.coveredDevicesIdx) {
+            const Decomposition::Lanes need = Decomposition::demand(devices[d_idx]);
+            for (int slot = candidates.first(d_idx); slot < candidates.last(d_idx); ++slot) {
+                const Decomposition::Lanes& cap = capacity[candidates.serverIds[slot]];
+                bool ok = true;
+                for (int r = 0; r < LANES; ++r) ok = ok && need[r] <= cap[r];
+                fits[slot] = ok;
+            }
+        }
+
+        std::vector<Decomposition::Lanes> lambda(numServers, Decomposition::Lanes{});
+        std::vector<Decomposition::Lanes> bestLambda = lambda;
+        std::vector<Decomposition::Lanes> price(numServers, Decomposition::Lanes{});
+        std::vector<Decomposition::Lanes> load(numServers, Decomposition::Lanes{});
+        std::vector<Decomposition::Lanes> direction(numServers, Decomposition::Lanes{});
+        std::vector<char> open(numServers, 0);
+
+        // The first round lets the steps overshoot, which is how they leave the flat region
+        // around lambda = 0, where devices move to whichever servers are still free. The
+        // second starts again from the best multipliers and returns to them whenever the
+        // step factor is halved, so that a diverging factor cannot lose the bound.
+        bool done = false;
+        for (int round = 0; round < 2 && !done; ++round) {
+            const bool restart = round > 0;
+            lambda = bestLambda;
+            for (auto& lanes : direction) lanes.fill(0.0);
+            double theta = options.step;
+            int stalled = 0;
+            double levelBest = -std::numeric_limits<double>::infinity();
+            for (int it = 0; it < options.iterations; ++it) {
+                ++bound.iterations;
+
+                // Relaxed problem: servers open when their prices outweigh their cost.
+                double L = 0.0;
+                for (size_t i = 1; i < numServers; ++i) {
+                    double total = 0.0;
+                    for (int r = 0; r < LANES; ++r) {
+                        price[i][r] = capacity[i][r] > 0.0 ? lambda[i][r] / capacity[i][r] : 0.0;
+                        total += lambda[i][r];
+                    }
+                    open[i] = total > servers[i].csc;
+                    if (open[i]) L += servers[i].csc - total;
+                    load[i].fill(0.0);
+                }
+
+                // Devices take their cheapest priced slot, or stay unserved.
+                for (int d_idx : state.coveredDevicesIdx) {
+                    const Device& device = devices[d_idx];
+                    const Decomposition::Lanes need = Decomposition::demand(device);
+                    double best = device.cnd;
+                    int bestServer = 0;
+                    for (int slot = candidates.first(d_idx); slot < candidates.last(d_idx); ++slot) {
+                        if (!fits[slot]) continue;
+                        const int i = candidates.serverIds[slot];
+                        double cost = 0.0;
+                        for (int r = 0; r < LANES; ++r) cost += price[i][r] * need[r];
+                        if (cost < best) {
+                            best = cost;
+                            bestServer = i;
+                        }
+                    }
+                    L += best;
+                    if (bestServer != 0) {
+                        for (int r = 0; r < LANES; ++r) load[bestServer][r] += need[r];
+                    }
+                }
+
+                // The step factor is halved when a whole window of steps fails to raise the bound of the current factor.
+                if (L > bound.value) {
+                    bound.value = L;
+                    bestLambda = lambda;
+                }
+                if (L > levelBest) {
+                    levelBest = L;
+                    stalled = 0;
+                } else if (++stalled >= options.stall) {
+                    theta *= 0.5;
+                    stalled = 0;
+                    levelBest = -std::numeric_limits<double>::infinity();
+                    if (restart) {
+                        lambda = bestLambda;
+                        for (auto& lanes : direction) lanes.fill(0.0);
+                        continue;
+                    }
+                }
+                done = bound.upperBound - bound.value <= options.tolerance * bound.upperBound;
+                if (done || theta < 1e-6) break;
+
+                // Subgradient of the relaxed rows, in shares of the server capacity, deflected
+                // by the previous direction to damp the zig-zag between overloaded servers.
+                double norm = 0.0;
+                for (size_t i = 1; i < numServers; ++i) {
+                    for (int r = 0; r < LANES; ++r) {
+                        const double g = capacity[i][r] > 0.0 ? load[i][r] / capacity[i][r] - (open[i] ? 1.0 : 0.0) : 0.0;
+                        direction[i][r] = g + options.deflection * direction[i][r];
+                        norm += direction[i][r] * direction[i][r];
+                    }
+                }
+                if (norm <= 0.0) break;
+
+                const double t = theta * std::max(bound.upperBound - L, 0.0) / norm;
+                for (size_t i = 1; i < numServers; ++i) {
+                    for (int r = 0; r < LANES; ++r) lambda[i][r] = std::max(0.0, lambda[i][r] + t * direction[i][r]);
+                }
+            }
+        }
+        bound.value = std::min(bound.value, bound.upperBound);
+        return bound;
+    }
+
+    /**
+     * @brief Records a lower bound on the total cost in the metrics of a state.
+     * @details The bound is given in model units (as returned by `lagrangian` or
+     * `MathModels::lpRelaxation`); the cost of non-coverage, which no allocation can
+     * avoid, is added so that it bounds `total_cost`. Every metrics object later built
+     * from this state inherits it and reports its own optimality gap.
+     *
+     * @param[in,out] state The state whose base metrics receive the bound.
+     * @param[in] method The name of the bound (e.g., "Lagrangian" or "LP").
+     * @param[in] value The bound on the allocation cost.
+     * @param[in] seconds The time the bound took.
+     */
+    inline void record(Result& state, const std::string& method, double value, double seconds) {
+        if (!state.metrics) return;
+        Metrics::LowerBound& bound = state.metrics->bound;
+        bound.method = method;
+        bound.value = value + state.metrics->outputs.cost_of_non_coverage;
+        bound.seconds = seconds;
+    }
+
+    /**
+     * @brief Computes the Lagrangian bound of a state and records it in its metrics.
+     * @param[in,out] state The pre-calculated state.
+     * @param[in] options The stopping rule and step schedule.
+     * @return The bound on the allocation cost.
+     */
+    inline Bound certify(Result& state, const Options& options = {}) {
+        double seconds = 0.0;
+        Profiling::ScopedTimer timer("LowerBounds::lagrangian", &seconds, "bound");
+        const Bound bound = lagrangian(state, options);
+        timer.stop();
+        record(state, "Lagrangian", bound.value, seconds);
+        return bound;
+    }
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "Decomposition.h"
+#include "Heuristics.h"
+#include "MetaHeuristics.h"
 #include "NetworkResourceAllocation.h"
 
 #include <ilcplex/ilocplex.h>
@@ -8,144 +11,341 @@ typedef IloArray<IloNumVarArray> NumVar2D;
 typedef IloArray<NumVar2D>       NumVar3D;
 
 namespace MathModels {
+
+    /**
+     * @struct ModelOptions
+     * @brief Debugging switches for the construction of a CPLEX model.
+     * @details Both options are off by default: naming tens of thousands of variables
+     * and writing the .lp file cost noticeable time before `solve()` even starts, and
+     * are only needed when inspecting a model by hand.
+     */
+    struct ModelOptions {
+        bool nameVariables = false; ///< Give every variable a readable name (e.g. "x_s(3)_d(17)").
+        bool exportModel = false;   ///< Write the model to `<baseDir>/models/<baseName>.lp`; implies `nameVariables`.
+    };
+
+    /**
+     * @struct WarmStart
+     * @brief Selects the algorithm whose solution seeds the CPLEX search.
+     * @details When `heuristic` is set, it is run on a copy of the state (optionally
+     * followed by `metaheuristic`) and the resulting assignment is passed to CPLEX as a
+     * MIP start. With `cutoff`, its cost also becomes the upper objective cutoff, so
+     * the solver prunes every node that cannot beat it.
+     */
+    struct WarmStart {
+        std::string heuristic;     ///< Heuristic for the initial solution (e.g., "Greedy_DescAsc"); empty disables the warm start.
+        std::string metaheuristic; ///< Optional meta-heuristic run on the heuristic solution (e.g., "SA").
+        double T = 100.0;          ///< Initial temperature when `metaheuristic` is "SA".
+        double alpha = 0.95;       ///< Cooling rate when `metaheuristic` is "SA".
+        MetaHeuristics::TabuOptions tabu; ///< Search settings when `metaheuristic` is "Tabu" or "ILS".
+        bool cutoff = true;        ///< Use the incumbent cost as the objective upper cutoff.
+
+        inline bool enabled() const { return !heuristic.empty(); }
+        inline std::string name() const { return metaheuristic.empty() ? heuristic : metaheuristic + "-" + heuristic; }
+    };
+
+    /**
+     * @struct SolverConfig
+     * @brief The CPLEX parameters and options of one solver run.
+     * @details The defaults reproduce the historical settings (one thread, 1200 s). The
+     * numeric codes of `emphasis` and `nodeFileStrategy` are passed to CPLEX unchanged;
+     * see `IloCplex::Param::Emphasis::MIP` (0 balanced, 1 feasibility, 2 optimality,
+     * 3 best bound, 4 hidden feasibility, 5 heuristic) and
+     * `IloCplex::Param::MIP::Strategy::File` (0 none, 1 in memory compressed, 2 on disk,
+     * 3 on disk compressed).
+     */
+    struct SolverConfig {
+        int threads = 1;             ///< Threads for this run (0 lets CPLEX use every core).
+        double timeLimit = 1200.0;   ///< Wall-clock time limit (s).
+        double mipGap = 1e-4;        ///< Relative MIP gap at which the search stops.
+        int emphasis = 0;            ///< MIP emphasis switch.
+        int nodeFileStrategy = 1;    ///< Node file strategy, for trees that outgrow the working memory.
+        ModelOptions model;          ///< Debugging switches for the model construction.
+        WarmStart warmStart;         ///< The algorithm whose solution seeds the search; disabled by default.
+        Decomposition::Options decomposition; ///< Clusters and coordination rounds of "Minimize_Cost_Decomposed".
+    };
+
     namespace {
         /**
-         * @brief Solves the resource allocation problem as an Integer Linear Programming (ILP) model using CPLEX.
-         * @details This function formulates and solves the optimization model.
-         * The objective is to minimize the total cost, defined as the sum of activation
-         * costs for used servers and penalty costs for devices that are covered but not
-         * served. It defines three primary binary decision variables:
-         * - w_d: 1 if device d is NOT served, 0 otherwise.
-         * - x_i^d: 1 if device d is allocated to server i, 0 otherwise.
-         * - z_i: 1 if server i is active, 0 otherwise.
-         * The model includes constraints for device assignment uniqueness, server resource
-         * capacities (BW, MEM, PCN, PCC, STO), and linking device assignments to server
-         * activation. The function also configures the solver, exports the model to a
-         * .lp file for analysis, and saves a solver log.
+         * @struct ServerReverseIndex
+         * @brief The devices (and their candidate slots) that can reach each server.
+         * @details The entries of server `i` are stored, in ascending device order, in
+         * `[offsets[i], offsets[i + 1])` of `devices` and `slots`.
+         */
+        struct ServerReverseIndex {
+            iVec offsets;
+            iVec devices;
+            iVec slots;
+
+            /**
+             * @brief Inverts a candidate table.
+             * @param[in] candidates The device-to-server candidate table.
+             * @param[in] numServers The size of the (1-indexed) server vector.
+             */
+            ServerReverseIndex(const CandidateTable& candidates, size_t numServers)
+                : offsets(numServers + 1, 0), devices(candidates.size()), slots(candidates.size()) {
+                for (int id : candidates.serverIds) offsets[id + 1]++;
+                for (size_t i = 0; i < numServers; ++i) offsets[i + 1] += offsets[i];
+
+                iVec next(offsets.begin(), offsets.end() - 1);
+                for (int d = 0; d + 1 < (int) candidates.offsets.size(); ++d) {
+                    for (int slot = candidates.first(d); slot < candidates.last(d); ++slot) {
+                        const int k = next[candidates.serverIds[slot]]++;
+                        devices[k] = d;
+                        slots[k] = slot;
+                    }
+                }
+            }
+        };
+
+        /**
+         * @struct Incumbent
+         * @brief A feasible allocation handed to the solver as a MIP start.
+         */
+        struct Incumbent {
+            const Result& state; ///< The allocated state; its ledger assignment and `on` flags are read.
+            double cost;         ///< Its cost (non-service + servers used), in model objective units.
+            bool cutoff;         ///< Use `cost` as the objective upper cutoff.
+        };
+
+        /**
+         * @struct CostModel
+         * @brief The cost-minimization model and its decision variables.
+         */
+        struct CostModel {
+            IloModel model;
+            IloNumVarArray w; ///< w^{d}: 1 if device d is NOT served, indexed by device.
+            IloNumVarArray x; ///< x_{i}^{d}: 1 if device d is allocated to server i, indexed by candidate slot.
+            IloNumVarArray z; ///< z_i: 1 if server i is active, indexed by server.
+        };
+
+        /**
+         * @brief Builds the sparse cost-minimization model of a state, without solving it.
+         * @details Declares the w, x and z variables (naming them if requested), the
+         * objective and the assignment, linking and capacity constraints described in
+         * `minimizeCost`. Nothing is sent to the solver, so the time spent here is the
+         * model-building cost alone.
          *
-         * @param[in,out] state A reference to the Result object. It provides the initial
-         * problem data and is updated in-place with the optimal allocation found by the solver.
-         * @param[in,out] metrics A reference to the MathMetrics object to be populated with
-         * solver results, including objective value, MIP gap, and execution time.
-         * @note This function is intended for internal use within the MathModels namespace.
-         * @exception IloException Catches and reports CPLEX-specific errors.
+         * @param[in] env The CPLEX environment that owns the model.
+         * @param[in] state The pre-calculated state whose candidate table defines the variables.
+         * @param[in] nameVariables Give every variable a readable name.
+         * @return The model and its variables, all owned by `env`.
+         * @exception IloException Propagated to the caller, which owns `env`.
          */
-        inline void minimizeCost(Result& state, MathMetrics& metrics) {
-            Devices& devices = state.devices;
-            Servers& servers = state.servers;
+        inline CostModel buildCostModel(IloEnv env, const Result& state, bool nameVariables) {
+            const Devices& devices = state.devices;
+            const Servers& servers = state.servers;
             const iVec& coveredDevicesIdx = state.coveredDevicesIdx;
+            const CandidateTable& candidates = *state.candidates;
 
-            IloEnv env;
-            try {
-                IloModel model(env);
+            CostModel m;
+            m.model = IloModel(env);
 
-                //=========================================================================
-                // 1. VARIABLE DECLARATION
-                //=========================================================================
+            //=========================================================================
+            // 1. VARIABLE DECLARATION
+            //=========================================================================
+
+            // w^{d}: 1 if device d is NOT served, 0 otherwise.
+            m.w = IloNumVarArray(env, devices.size(), 0, 1, ILOBOOL);
 
-                // w^{d}: 1 if device d is NOT served, 0 otherwise.
-                IloNumVarArray w(env, devices.size(), 0, 1, ILOBOOL);
+            // x_{i}^{d}: 1 if device d is allocated to server i, 0 otherwise.
+            // Indexed by candidate slot: x[slot] is the pair (candidates.serverIds[slot], d).
+            m.x = IloNumVarArray(env, candidates.size(), 0, 1, ILOBOOL);
+
+            // z_i: 1 if server i is active, 0 otherwise.
+            m.z = IloNumVarArray(env, servers.size(), 0, 1, ILOBOOL);
+
+            if (nameVariables) {
                 for (size_t d_idx = 1; d_idx < devices.size(); ++d_idx) {
                     std::string name = "w_d(" + std::to_string(d_idx) + ")";
-                    w[d_idx].setName(name.c_str());
-                }
-
-                // x_{i}^{d}: 1 if device d is allocated to server i, 0 otherwise.
-                NumVar2D x(env, servers.size());
-                for (size_t i = 1; i < servers.size(); ++i) {
-                    x[i] = IloNumVarArray(env, devices.size(), 0, 1, ILOBOOL);
-                    for (size_t d_idx = 1; d_idx < devices.size(); ++d_idx) {
-                        std::string name = "x_s(" + std::to_string(i) + ")_d(" + std::to_string(d_idx) + ")";
-                        x[i][d_idx].setName(name.c_str());
+                    m.w[d_idx].setName(name.c_str());
+                    for (int slot = candidates.first((int) d_idx); slot < candidates.last((int) d_idx); ++slot) {
+                        name = "x_s(" + std::to_string(candidates.serverIds[slot]) + ")_d(" + std::to_string(d_idx) + ")";
+                        m.x[slot].setName(name.c_str());
                     }
                 }
-
-                // z_i: 1 if server i is active, 0 otherwise.
-                IloNumVarArray z(env, servers.size(), 0, 1, ILOBOOL);
                 for (size_t i = 1; i < servers.size(); ++i) {
                     std::string name = "z_s(" + std::to_string(i) + ")";
-                    z[i].setName(name.c_str());
+                    m.z[i].setName(name.c_str());
                 }
+            }
 
-                //=========================================================================
-                // 2. OBJECTIVE FUNCTION
-                // Minimize total cost: server activation costs + non-service penalties.
-                //=========================================================================
+            //=========================================================================
+            // 2. OBJECTIVE FUNCTION
+            // Minimize total cost: server activation costs + non-service penalties.
+            //=========================================================================
 
-                IloExpr obj(env);
-                for (size_t i = 1; i < servers.size(); ++i) {
-                    obj += servers[i].csc * z[i];
+            IloExpr obj(env);
+            for (size_t i = 1; i < servers.size(); ++i) {
+                obj += servers[i].csc * m.z[i];
+            }
+            for (int d_idx : coveredDevicesIdx) {
+                obj += devices[d_idx].cnd * m.w[d_idx];
+            }
+            m.model.add(IloMinimize(env, obj));
+            obj.end();
+
+            //=========================================================================
+            // 3. CONSTRAINTS
+            //=========================================================================
+
+            for (int d_idx : coveredDevicesIdx) {
+                // Constraint (1): Each device is served by at most one server.
+                IloExpr c1(env);
+                for (int slot = candidates.first(d_idx); slot < candidates.last(d_idx); ++slot) {
+                    c1 += m.x[slot];
                 }
-                for (int d_idx : coveredDevicesIdx) {
-                    obj += devices[d_idx].cnd * w[d_idx];
+                m.model.add(c1 == 1 - m.w[d_idx]);
+                c1.end();
+                
+                // Link x and z: A device can only be assigned to an active server (z_i=1).
+                for (int slot = candidates.first(d_idx); slot < candidates.last(d_idx); ++slot) {
+                    m.model.add(m.x[slot] <= m.z[candidates.serverIds[slot]]);
                 }
-                model.add(IloMinimize(env, obj));
-                obj.end();
+                
+            }
 
-                //=========================================================================
-                // 3. CONSTRAINTS
-                //=========================================================================
+            // Constraints (2-6): Server resource capacity limits, over the devices that can reach server 'i'.
+            const ServerReverseIndex reachable(candidates, servers.size());
+            for (size_t i = 1; i < servers.size(); ++i) {
+                IloExpr c2_bw(env), c3_mem(env), c4_pcn(env), c5_pcc(env), c6_sto(env);
+                for (int k = reachable.offsets[i]; k < reachable.offsets[i + 1]; ++k) {
+                    const int slot = reachable.slots[k];
+                    const Device& device = devices[reachable.devices[k]];
+                    c2_bw  += device.bw  * m.x[slot]; // Bandwidth
+                    c3_mem += device.mem * m.x[slot]; // Memory
+                    c4_pcn += device.pcn * m.x[slot]; // Num. Cores
+                    c5_pcc += device.pcc * m.x[slot]; // Proc. Capacity
+                    c6_sto += device.sto * m.x[slot]; // Storage
+                }
+                m.model.add(c2_bw  <= m.z[i] * servers[i].bw); 
+                m.model.add(c3_mem <= m.z[i] * servers[i].mem); 
+                m.model.add(c4_pcn <= m.z[i] * servers[i].pcn); 
+                m.model.add(c5_pcc <= m.z[i] * servers[i].pcc_total); 
+                m.model.add(c6_sto <= m.z[i] * servers[i].sto); 
+                c2_bw.end(); c3_mem.end(); c4_pcn.end(); c5_pcc.end(); c6_sto.end();
+            }
 
-                for (int d_idx : coveredDevicesIdx) {
-                    Device& device = devices[d_idx];
-                    // Constraint (1): Each device is served by at most one server.
-                    IloExpr c1(env);
-                    for (const auto& s_info : device.servers) {
-                        c1 += x[s_info.id][d_idx];
-                    }
-                    model.add(c1 == 1 - w[d_idx]);
-                    c1.end();
-                    
-                    // Link x and z: A device can only be assigned to an active server (z_i=1).
-                    for (const auto& s_info : device.servers) {
-                        model.add(x[s_info.id][d_idx] <= z[s_info.id]);
-                    }
-                    
+            return m;
+        }
+
+        /**
+         * @brief Applies the solver parameters of a run.
+         */
+        inline void configure(IloCplex& cplex, const SolverConfig& config) {
+            cplex.setParam(IloCplex::Param::Threads, config.threads);
+            cplex.setParam(IloCplex::Param::TimeLimit, config.timeLimit);
+            cplex.setParam(IloCplex::Param::MIP::Tolerances::MIPGap, config.mipGap);
+            cplex.setParam(IloCplex::Param::Emphasis::MIP, config.emphasis);
+            cplex.setParam(IloCplex::Param::MIP::Strategy::File, config.nodeFileStrategy);
+            //cplex.setParam(IloCplex::Param::MIP::Tolerances::Integrality, 1e-9);
+        }
+
+        /**
+         * @brief Adds a feasible assignment as a complete MIP start (every w, x and z value).
+         * @param[in] env The environment that owns the model.
+         * @param[in,out] cplex The solver to seed.
+         * @param[in] problem The model variables.
+         * @param[in] state The state the model was built from.
+         * @param[in] assignment Indexed by device; the server id of each device, or 0 if unserved.
+         */
+        inline void addMIPStart(IloEnv env, IloCplex& cplex, const CostModel& problem, const Result& state, const iVec& assignment) {
+            const CandidateTable& candidates = *state.candidates;
+            std::vector<char> on(state.servers.size(), 0);
+            IloNumVarArray startVars(env);
+            IloNumArray startVals(env);
+            for (int d_idx : state.coveredDevicesIdx) {
+                startVars.add(problem.w[d_idx]);
+                startVals.add(assignment[d_idx] == 0 ? 1 : 0);
+                on[assignment[d_idx]] = 1;
+                for (int slot = candidates.first(d_idx); slot < candidates.last(d_idx); ++slot) {
+                    startVars.add(problem.x[slot]);
+                    startVals.add(candidates.serverIds[slot] == assignment[d_idx] ? 1 : 0);
                 }
+            }
+            for (size_t i = 1; i < state.servers.size(); ++i) {
+                startVars.add(problem.z[i]);
+                startVals.add(on[i] ? 1 : 0);
+            }
+            cplex.addMIPStart(startVars, startVals, IloCplex::MIPStartCheckFeas, "warm_start");
+            startVars.end();
+            startVals.end();
+        }
 
-                // Constraints (2-6): Server resource capacity limits.
-                for (size_t i = 1; i < servers.size(); ++i) {
-                    IloExpr c2_bw(env), c3_mem(env), c4_pcn(env), c5_pcc(env), c6_sto(env);
-                    for (int d_idx : coveredDevicesIdx) {
-                        // Check if server 'i' is a potential server for device 'd_idx'
-                        bool is_potential = false;
-                        for (const auto& s_info : devices[d_idx].servers) {
-                            if (s_info.id == i) {
-                                is_potential = true;
-                                break;
-                            }
-                        }
-                        if (is_potential) {
-                            c2_bw  += devices[d_idx].bw  * x[i][d_idx]; // Bandwidth
-                            c3_mem += devices[d_idx].mem * x[i][d_idx]; // Memory
-                            c4_pcn += devices[d_idx].pcn * x[i][d_idx]; // Num. Cores
-                            c5_pcc += devices[d_idx].pcc * x[i][d_idx]; // Proc. Capacity
-                            c6_sto += devices[d_idx].sto * x[i][d_idx]; // Storage
+        /**
+         * @brief Allocates every device as in the solver's solution.
+         */
+        inline void applySolution(const IloCplex& cplex, const CostModel& problem, Result& state) {
+            const CandidateTable& candidates = *state.candidates;
+            for (int d_idx : state.coveredDevicesIdx) {
+                if (cplex.getValue(problem.w[d_idx]) < 0.5) {
+                    for (int slot = candidates.first(d_idx); slot < candidates.last(d_idx); ++slot) {
+                        if (cplex.getValue(problem.x[slot]) > 0.5) {
+                            NetworkResourceAllocation::assign(state, state.devices[d_idx], candidates.entry(d_idx, slot));
+                            break; // Move to the next device
                         }
                     }
-                    model.add(c2_bw  <= z[i] * servers[i].bw); 
-                    model.add(c3_mem <= z[i] * servers[i].mem); 
-                    model.add(c4_pcn <= z[i] * servers[i].pcn); 
-                    model.add(c5_pcc <= z[i] * servers[i].pcc_total); 
-                    model.add(c6_sto <= z[i] * servers[i].sto); 
-                    c2_bw.end(); c3_mem.end(); c4_pcn.end(); c5_pcc.end(); c6_sto.end();
                 }
+            }
+        }
+
+        /**
+         * @brief Solves the resource allocation problem as an Integer Linear Programming (ILP) model using CPLEX.
+         * @details This function formulates and solves the optimization model.
+         * The objective is to minimize the total cost, defined as the sum of activation
+         * costs for used servers and penalty costs for devices that are covered but not
+         * served. It defines three primary binary decision variables:
+         * - w_d: 1 if device d is NOT served, 0 otherwise.
+         * - x_i^d: 1 if device d is allocated to server i, 0 otherwise.
+         * - z_i: 1 if server i is active, 0 otherwise.
+         * The model is sparse: x_i^d only exists for the (device, potential server) pairs
+         * of the candidate table, one variable per candidate slot, and the capacity rows
+         * are assembled from a server-to-slots reverse index.
+         * The model includes constraints for device assignment uniqueness, server resource
+         * capacities (BW, MEM, PCN, PCC, STO), and linking device assignments to server
+         * activation. The function also configures the solver, saves a solver log and,
+         * if requested, exports the model to a .lp file for analysis; both are named after
+         * the scenario, its bottleneck flag and its seed (e.g., `D300_S105_4G_B0_{seed}.log`). An incumbent, when
+         * given, is added as a complete MIP start (every w, x and z value); if the solver
+         * ends without a solution (e.g., it rejected the start and found nothing under the
+         * cutoff), the incumbent's allocation and cost are reported, with a zero gap when
+         * the search proved there is nothing better. The time of
+         * the build, export, solve and write-back stages is recorded in `metrics.solver`.
+         *
+         * @param[in,out] state A reference to the Result object. It provides the initial
+         * problem data and is updated in-place with the optimal allocation found by the solver.
+         * @param[in,out] metrics A reference to the MathMetrics object to be populated with
+         * solver results, including objective value, MIP gap, and execution time.
+         * @param[in] config The solver parameters and model options of this run.
+         * @param[in] incumbent An optional feasible solution to warm-start the search from.
+         * @note This function is intended for internal use within the MathModels namespace.
+         * @exception IloException Catches and reports CPLEX-specific errors.
+         */
+        inline void minimizeCost(Result& state, MathMetrics& metrics, const SolverConfig& config, const std::optional<Incumbent>& incumbent) {
+            const ModelOptions& options = config.model;
+            const bool nameVariables = options.nameVariables || options.exportModel;
+
+            IloEnv env;
+            try {
+                // Sections 1-3: variables, objective and constraints.
+                Profiling::ScopedTimer build("buildCostModel", &metrics.solver.build_sec);
+                CostModel problem = buildCostModel(env, state, nameVariables);
+                build.stop();
 
                 //=========================================================================
                 // 4. SOLVER CONFIGURATION AND EXECUTION
                 //=========================================================================
 
-                IloCplex cplex(model);
-                cplex.setParam(IloCplex::Param::Threads, 1);
-                cplex.setParam(IloCplex::Param::TimeLimit, 1200);
-                //cplex.setParam(IloCplex::Param::MIP::Tolerances::Integrality, 1e-9);
+                IloCplex cplex(problem.model);
+                configure(cplex, config);
 
+                // The bottleneck flag and the seed keep the runs of an experiment, which may
+                // solve concurrently, from sharing (and truncating) one log or model file.
                 std::filesystem::path baseDir = metrics.getBaseDirectoryPath();
-                std::string baseName = metrics.getBaseFileName();
+                std::string baseName = metrics.getBaseFileName() + "_B" + (metrics.inputs.bottlenecks ? "1" : "0") + "_" + std::to_string(metrics.inputs.seed);
                 std::filesystem::path logDir = baseDir / "logs";
                 std::filesystem::path modelDir = baseDir / "models";
                 std::filesystem::create_directories(logDir);
-                std::filesystem::create_directories(modelDir);
                 std::filesystem::path logPath = logDir / (baseName + ".log");
                 std::filesystem::path modelPath = modelDir / (baseName + ".lp");
 
@@ -156,38 +356,50 @@ namespace MathModels {
                     cplex.setOut(env.getNullStream());
                 }
 
-                cplex.exportModel(modelPath.c_str());
+                if (options.exportModel) {
+                    Profiling::ScopedTimer exportTimer("exportModel", &metrics.solver.export_sec);
+                    std::filesystem::create_directories(modelDir);
+                    cplex.exportModel(modelPath.c_str());
+                }
 
-                auto startChrono = std::chrono::high_resolution_clock::now();
-                cplex.solve();
-                auto endChrono = std::chrono::high_resolution_clock::now();
-                metrics.outputs.execution_time_sec = std::chrono::duration<double>(endChrono - startChrono).count();
+                if (incumbent) {
+                    addMIPStart(env, cplex, problem, state, incumbent->state.ledger.assignment);
+
+                    // The small slack keeps an equally good optimum from being pruned if the start is rejected.
+                    if (incumbent->cutoff) {
+                        cplex.setParam(IloCplex::Param::MIP::Tolerances::UpperCutoff, incumbent->cost + 1e-6);
+                    }
+                }
+
+                Profiling::ScopedTimer solve("cplex.solve", &metrics.solver.solve_sec);
+                const bool solved = cplex.solve();
+                metrics.outputs.execution_time_sec += solve.stop();
 
                 std::stringstream status;
                 status << cplex.getStatus();
                 metrics.status = status.str();
-                metrics.OF = (double)cplex.getObjValue() + metrics.outputs.cost_of_non_coverage;
-                metrics.gap = cplex.getMIPRelativeGap();
-
                 logFile.close();
 
                 //=========================================================================
                 // 5. PARSE RESULTS
                 //=========================================================================
 
-                for (int d_idx : coveredDevicesIdx) {
-                    if (cplex.getValue(w[d_idx]) < 0.5) {
-                        for (const auto& s_info : devices[d_idx].servers) {
-                            if (cplex.getValue(x[s_info.id][d_idx]) > 0.5) {
-                                servers[s_info.id].addServed(devices[d_idx]);
-                                devices[d_idx].server = s_info;
-                                break; // Move to the next device
-                            }
-                        }
-                    }
+                Profiling::ScopedTimer writeback("writeBack", &metrics.solver.writeback_sec);
+                if (solved) {
+                    metrics.OF = (double)cplex.getObjValue() + metrics.outputs.cost_of_non_coverage;
+                    metrics.gap = cplex.getMIPRelativeGap();
+                    applySolution(cplex, problem, state);
+                } else if (incumbent) {
+                    // With a cutoff, a rejected start can leave the solver with nothing better
+                    // than the incumbent, which is then the solution of the run.
+                    MetaHeuristics::restoreAssignment(state, incumbent->state.ledger.assignment);
+                    metrics.OF = incumbent->cost + metrics.outputs.cost_of_non_coverage;
+                    if (cplex.getStatus() == IloAlgorithm::Infeasible) metrics.gap = 0.0;
+                } else {
+                    std::cerr << "Error: CPLEX found no solution (" << metrics.status << ")." << std::endl;
                 }
 
-                NetworkResourceAllocation::calculateMetrics(devices, servers, metrics);
+                NetworkResourceAllocation::calculateMetrics(state, metrics);
 
             } catch (const IloException& e) {
                 std::cerr << "CPLEX Error: " << e.getMessage() << std::endl;
@@ -196,32 +408,269 @@ namespace MathModels {
             }
             env.end();
         }
+
+        /**
+         * @struct ClusterOutcome
+         * @brief What the solver reported for the last solve of one cluster.
+         */
+        struct ClusterOutcome {
+            std::string status = "Unknown";
+            double gap = 1.0;
+            MathMetrics::SolverTimes times;
+        };
+
+        /**
+         * @brief Solves the cost-minimization model of one cluster's sub-state in its own `IloEnv`.
+         * @param[in,out] sub The sub-state, allocated in place with the solution.
+         * @param[in] config The solver parameters of the sub-ILP.
+         * @param[in] start An optional feasible assignment of the sub-state passed as a MIP start.
+         * @param[out] outcome The status, gap and stage times of the solve.
+         * @return `true` if the solver produced a solution, `false` otherwise (an error is logged).
+         */
+        inline bool solveCluster(Result& sub, const SolverConfig& config, const iVec* start, ClusterOutcome& outcome) {
+            bool solved = false;
+            IloEnv env;
+            try {
+                Profiling::ScopedTimer build("buildCostModel", &outcome.times.build_sec);
+                CostModel problem = buildCostModel(env, sub, false);
+                build.stop();
+
+                IloCplex cplex(problem.model);
+                configure(cplex, config);
+                cplex.setOut(env.getNullStream());
+                if (start) addMIPStart(env, cplex, problem, sub, *start);
+
+                Profiling::ScopedTimer solve("cplex.solve", &outcome.times.solve_sec);
+                solved = cplex.solve();
+                solve.stop();
+
+                std::stringstream status;
+                status << cplex.getStatus();
+                outcome.status = status.str();
+                if (solved) {
+                    outcome.gap = cplex.getMIPRelativeGap();
+                    Profiling::ScopedTimer writeback("writeBack", &outcome.times.writeback_sec);
+                    applySolution(cplex, problem, sub);
+                }
+            } catch (const IloException& e) {
+                std::cerr << "CPLEX Error: " << e.getMessage() << std::endl;
+                solved = false;
+            } catch (...) {
+                std::cerr << "An unknown error occurred in the CPLEX model." << std::endl;
+                solved = false;
+            }
+            env.end();
+            return solved;
+        }
+
+        /**
+         * @brief Solves the cost-minimization model cluster by cluster, for instances too large for one ILP.
+         * @details `Decomposition::solve` cuts the instance into geographic clusters of at
+         * most `config.decomposition.maxDevices` devices and coordinates their shares of the
+         * cloud capacity over `config.decomposition.rounds` rounds. Each cluster's sub-ILP
+         * is the model of `minimizeCost` restricted to its devices, its edge servers and its
+         * cloud shares, solved in its own `IloEnv` with `config.threads` threads; the
+         * clusters of a round are solved concurrently. The time limit is split so that the
+         * whole run stays within `config.timeLimit`. Later rounds start from the previous
+         * solution of each cluster, and the first one from the incumbent, when given.
+         *
+         * The reported status is the one the final round's sub-ILPs agree on, or else the
+         * first that is not "Optimal"; the gap is the largest gap of those sub-ILPs, each
+         * relative to its own cluster (not a bound on the whole instance); the stage times
+         * add up the solves of every cluster and round.
+         *
+         * @param[in,out] state The state to solve; updated in-place with the merged allocation.
+         * @param[in,out] metrics The metrics to populate.
+         * @param[in] config The solver parameters and the decomposition options.
+         * @param[in] incumbent An optional feasible solution to warm-start the first round from.
+         */
+        inline void minimizeCostDecomposed(Result& state, MathMetrics& metrics, const SolverConfig& config, const std::optional<Incumbent>& incumbent) {
+            Decomposition::Options options = config.decomposition;
+            const std::vector<Decomposition::Cluster> clusters = Decomposition::partition(state, options.maxDevices);
+            const size_t clusterCount = clusters.size();
+            if (options.concurrent == 0) options.concurrent = Parallel::defaultThreads();
+            options.concurrent = std::max(1u, std::min<unsigned>(options.concurrent, (unsigned) std::max<size_t>(clusterCount, 1)));
+
+            // Every round solves its clusters in waves of `concurrent`.
+            const size_t waves = (std::max<size_t>(clusterCount, 1) + options.concurrent - 1) / options.concurrent;
+            SolverConfig clusterConfig = config;
+            clusterConfig.timeLimit = config.timeLimit / (double) (std::max(options.rounds, 1) * waves);
+            clusterConfig.threads = std::max(config.threads, 1);
+
+            std::vector<ClusterOutcome> outcomes(clusterCount);
+            std::vector<MathMetrics::SolverTimes> times(clusterCount);
+            auto solveOne = [&](Decomposition::Subproblem& sub, const iVec* start) {
+                ClusterOutcome& outcome = outcomes[sub.cluster];
+                outcome = ClusterOutcome();
+                const bool solved = solveCluster(sub.state, clusterConfig, start, outcome);
+                times[sub.cluster].build_sec += outcome.times.build_sec;
+                times[sub.cluster].solve_sec += outcome.times.solve_sec;
+                times[sub.cluster].writeback_sec += outcome.times.writeback_sec;
+                return solved;
+            };
+
+            Profiling::ScopedTimer timer("Decomposition::solve", &metrics.outputs.execution_time_sec, "solver");
+            const std::optional<Decomposition::Stats> stats =
+                Decomposition::solve(state, clusters, options, solveOne, incumbent ? &incumbent->state.ledger.assignment : nullptr);
+            timer.stop();
+            if (!stats) return;
+
+            metrics.status.clear();
+            metrics.gap = 0.0;
+            for (size_t c = 0; c < clusterCount; ++c) {
+                if (metrics.status.empty() || (metrics.status == "Optimal" && outcomes[c].status != metrics.status)) metrics.status = outcomes[c].status;
+                metrics.gap = std::max(metrics.gap, outcomes[c].gap);
+                metrics.solver.build_sec += times[c].build_sec;
+                metrics.solver.solve_sec += times[c].solve_sec;
+                metrics.solver.writeback_sec += times[c].writeback_sec;
+            }
+            NetworkResourceAllocation::calculateMetrics(state, metrics);
+            metrics.OF = state.tracker.allocationCost() + metrics.outputs.cost_of_non_coverage;
+        }
     }
 
     /**
-     * @brief Serves as the main entry point for running a mathematical optimization model.
-     * @details This function orchestrates the execution of a specific mathematical model.
-     * It creates a dedicated `MathMetrics` object to store results, calls the
-     * appropriate solver function (e.g., `minimizeCost`) based on the algorithm name,
-     * and, upon completion, triggers the display and saving of the final metrics.
+     * @brief Runs a mathematical optimization model without displaying or saving its metrics.
+     * @details Creates a dedicated `MathMetrics` object to store results and calls the
+     * appropriate solver function (e.g., `minimizeCost`) based on the algorithm name.
+     * With a warm start, the selected heuristic (and meta-heuristic) first runs on a
+     * copy of the state; its solution becomes the MIP start, and its run time is
+     * included in the reported execution time. Every call builds its own `IloEnv`, so
+     * independent states can be solved concurrently.
      *
-     * @param[in] algorithm The name of the mathematical model to execute (e.g., "Minimize_Cost").
+     * @param[in] algorithm The name of the mathematical model to execute: "Minimize_Cost", or
+     * "Minimize_Cost_Decomposed" to solve it cluster by cluster (see `minimizeCostDecomposed`).
      * @param[in,out] state The `Result` object containing the initial simulation state.
      * This object will be updated by the solver with the optimal solution.
+     * @param[in,out] rng The random number context used by a randomized warm start.
+     * @param[in] config The solver parameters and model options of this run.
+     * @return The solver metrics, or `nullptr` if an algorithm name is unknown.
      */
-    inline void bootup(const std::string& algorithm, Result& state) {
+    inline std::unique_ptr<MathMetrics> solve(const std::string& algorithm, Result& state, utils::Rng& rng, const SolverConfig& config = {}) {
         auto metrics = std::make_unique<MathMetrics>("Mathematical", algorithm, state.metrics);
+        const WarmStart& warmStart = config.warmStart;
+
+        std::optional<Result> warmState;
+        if (warmStart.enabled()) {
+            warmState.emplace(state);
+            warmState->metrics->outputs.execution_time_sec = 0.0;
+            if (!Heuristics::run(warmStart.heuristic, *warmState, rng)) return nullptr;
+            if (!warmStart.metaheuristic.empty() && !MetaHeuristics::run(warmStart.metaheuristic, *warmState, warmStart.T, warmStart.alpha, rng, {}, warmStart.tabu)) return nullptr;
+            metrics->outputs.execution_time_sec = warmState->metrics->outputs.execution_time_sec;
+            metrics->warm_start = warmStart.name();
+        }
+        std::optional<Incumbent> incumbent;
+        if (warmState) incumbent.emplace(Incumbent{*warmState, warmState->tracker.allocationCost(), warmStart.cutoff});
         
         if (algorithm == "Minimize_Cost") {
-            minimizeCost(state, *metrics);
+            minimizeCost(state, *metrics, config, incumbent);
+        } else if (algorithm == "Minimize_Cost_Decomposed") {
+            minimizeCostDecomposed(state, *metrics, config, incumbent);
         } else {
             std::cerr << "Error: Unknown mathematical model algorithm type." << std::endl;
-            return;
+            return nullptr;
+        }
+        return metrics;
+    }
+
+    /**
+     * @brief Solves the LP relaxation of the cost-minimization model, a lower bound on its optimum.
+     * @details The model of `minimizeCost` is built as usual and its w, x and z variables
+     * are converted to continuous ones; the state is not modified. The relaxation keeps
+     * the x <= z rows, so it is at least as tight as `LowerBounds::lagrangian`, at the
+     * price of a CPLEX solve.
+     *
+     * @param[in] state The pre-calculated state.
+     * @param[in] config The solver parameters (threads and time limit) of the solve.
+     * @return The bound on the allocation cost (non-service + servers used), or
+     * `std::nullopt` if the relaxation could not be solved to optimality (an error is logged).
+     */
+    inline std::optional<double> lpRelaxation(const Result& state, const SolverConfig& config = {}) {
+        std::optional<double> bound;
+        IloEnv env;
+        try {
+            CostModel problem = buildCostModel(env, state, false);
+            problem.model.add(IloConversion(env, problem.w, ILOFLOAT));
+            problem.model.add(IloConversion(env, problem.x, ILOFLOAT));
+            problem.model.add(IloConversion(env, problem.z, ILOFLOAT));
+
+            IloCplex cplex(problem.model);
+            configure(cplex, config);
+            cplex.setOut(env.getNullStream());
+            if (cplex.solve() && cplex.getStatus() == IloAlgorithm::Optimal) {
+                bound = (double) cplex.getObjValue();
+            } else {
+                std::cerr << "Error: The LP relaxation could not be solved to optimality." << std::endl;
+            }
+        } catch (const IloException& e) {
+            std::cerr << "CPLEX Error: " << e.getMessage() << std::endl;
+        } catch (...) {
+            std::cerr << "An unknown error occurred in the CPLEX model." << std::endl;
         }
+        env.end();
+        return bound;
+    }
 
-        if (state.metrics) {
+    /**
+     * @brief Displays and saves the metrics of a run produced by `solve`.
+     * @param[in] metrics The solver metrics; nothing is reported if it is null.
+     */
+    inline void report(const std::unique_ptr<MathMetrics>& metrics) {
+        if (metrics) {
             showStructs::showMetrics(*metrics);
             metrics->saveResultsToFile();
         }
     }
-}
\ No newline at end of file
+
+    /**
+     * @brief Serves as the main entry point for running a mathematical optimization model.
+     * @details This function orchestrates the execution of a specific mathematical model
+     * through `solve` and, upon completion, triggers the display and saving of the
+     * final metrics.
+     *
+     * @param[in] algorithm The name of the mathematical model to execute (e.g., "Minimize_Cost").
+     * @param[in,out] state The `Result` object containing the initial simulation state.
+     * This object will be updated by the solver with the optimal solution.
+     * @param[in,out] rng The random number context used by a randomized warm start.
+     * @param[in] config The solver parameters and model options of this run.
+     */
+    inline void bootup(const std::string& algorithm, Result& state, utils::Rng& rng, const SolverConfig& config = {}) {
+        if (!state.metrics) return;
+        report(solve(algorithm, state, rng, config));
+    }
+
+    /**
+     * @brief Solves several independent instances concurrently.
+     * @details Up to `concurrent` instances are solved at a time, each in its own thread
+     * and its own `IloEnv`, and the `totalThreads` cores are split evenly between them
+     * (overriding `config.threads`). Metrics are displayed and saved once every run has
+     * finished, in the order of `states`, so the output files are written serially.
+     *
+     * @param[in] algorithm The name of the mathematical model to execute (e.g., "Minimize_Cost").
+     * @param[in,out] states The instances to solve; each is updated in place with its solution.
+     * @param[in,out] rngs One random number context per instance, used by randomized warm starts.
+     * @param[in] config The solver parameters and model options shared by every run.
+     * @param[in] concurrent The number of instances solved at a time (0 uses one per core, up to the number of instances).
+     * @param[in] totalThreads The number of cores to split between the concurrent runs.
+     */
+    inline void bootupBatch(const std::string& algorithm, std::vector<Result>& states, std::vector<utils::Rng>& rngs, SolverConfig config = {},
+                            unsigned concurrent = 0, unsigned totalThreads = Parallel::defaultThreads()) {
+        if (states.size() != rngs.size()) {
+            std::cerr << "Error: Each instance of the batch needs its own random context." << std::endl;
+            return;
+        }
+        if (states.empty()) return;
+
+        totalThreads = std::max(totalThreads, 1u);
+        if (concurrent == 0) concurrent = totalThreads;
+        concurrent = std::max(1u, std::min<unsigned>(concurrent, (unsigned) states.size()));
+        config.threads = (int) std::max(1u, totalThreads / concurrent);
+
+        std::vector<std::unique_ptr<MathMetrics>> metrics(states.size());
+        Parallel::parallelFor(0, states.size(), [&](size_t r) {
+            if (states[r].metrics) metrics[r] = solve(algorithm, states[r], rngs[r], config);
+        }, concurrent, 1);
+
+        for (const auto& m : metrics) report(m);
+    }
+}
@@ -1,61 +1,327 @@
 #pragma once
 
+#include "Heuristics.h"
 #include "NetworkResourceAllocation.h"
+#include "Parallel.h"
+#include "StatePool.h"
+
+#include <cmath>
+#include <limits>
 
 namespace MetaHeuristics {
+    /**
+     * @struct Move
+     * @brief A compact record of a single device relocation inside a solution.
+     * @details Produced by `generateNeighbor` and applied in place on the current
+     * solution. It holds just enough information to roll the change back with
+     * `undoMove` when the neighbor is rejected, so no copy of the solution is needed.
+     */
+    struct Move {
+        int device = 0;     ///< Index of the relocated device (0 when no move was found).
+        int oldServer = 0;  ///< Server the device was on before the move (0 if it was unserved).
+        int newServer = 0;  ///< Server the device was moved to.
+        double delta = 0.0; ///< Change in cost (non-service + servers used) caused by the move.
+    };
+
+    /**
+     * @struct TabuOptions
+     * @brief Budgets of the Tabu Search and Iterated Local Search engines.
+     * @details A value of 0 derives the setting from the number of covered devices `n`.
+     */
+    struct TabuOptions {
+        int iterations = 0; ///< Neighborhood evaluations in total (0: 20 n).
+        int stall = 0;      ///< Evaluations without improvement that end a tabu phase (0: max(200, n)).
+        int tenure = 0;     ///< Evaluations a moved device stays tabu (0: about sqrt(n), at least 5).
+        int sample = 16;    ///< Devices whose moves are evaluated per iteration.
+        int kicks = 0;      ///< Random relocations of an ILS perturbation (0: max(3, n / 50)).
+    };
+
+    /**
+     * @struct SearchBudget
+     * @brief When a search run stops, and how Simulated Annealing adapts its schedule.
+     * @details Every limit applies per chain (per repetition); 0 disables it. With all
+     * defaults, SA follows its fixed geometric schedule until it freezes. The reason a
+     * run stopped is recorded in its `SearchCounters::stop_reason`.
+     */
+    struct SearchBudget {
+        double timeLimitSec = 0.0;  ///< Wall-clock seconds of search.
+        uint64_t maxIterations = 0; ///< Neighbors drawn (overrides `TabuOptions::iterations`).
+        int stagnationLevels = 0;   ///< SA temperature levels without a new best solution.
+        bool adaptive = false;      ///< Adapt SA cooling to the acceptance rate and reheat when frozen or stuck.
+    };
+
     namespace {
         /**
-         * @brief Generates a neighbor solution by attempting to move one device to a different server.
+         * @brief Generates a neighbor solution by moving one device to a different server, in place.
          * @details This function defines the neighborhood structure for the search. It randomly
          * selects a covered device and tries to reallocate it to a different potential
          * server. If a valid move is found (i.e., the new server has capacity), the
-         * solution's state (devices, servers) is updated directly. The function also
-         * updates the cost components (`cns`, `csu`) by reference to reflect the move's
-         * impact, such as activating a new server or deactivating an old one.
+         * solution's state is updated directly and the change is described by the returned
+         * `Move`. Its `delta` is reported by the state's objective tracker and accounts for
+         * the cost impact, such as activating a new server, deactivating an old one or
+         * serving a device that was previously unserved.
          *
-         * @param[in,out] devices The device vector of the solution to modify.
-         * @param[in,out] servers The server vector of the solution to modify.
-         * @param[in] coveredDevicesIdx A vector of indices for all covered devices.
-         * @param[in,out] cns Reference to the current solution's cost of non-service, updated on change.
-         * @param[in,out] csu Reference to the current solution's cost of servers used, updated on change.
+         * @param[in,out] state The solution to modify.
+         * @param[in] coveredDevicesIdx The covered devices the move may relocate (usually `state.coveredDevicesIdx`).
+         * @param[in,out] rng The random number context to draw from.
+         * @param[in,out] order Scratch space for the shuffled candidate slots, kept by the caller so that drawing a neighbor allocates nothing.
+         * @return The applied move. `device` is 0 and `delta` is 0.0 if no feasible move was found.
          */
-        inline void generateNeighbor(Devices& devices, Servers& servers, const iVec& coveredDevicesIdx, double& cns, double& csu) {
-            int idx = utils::randomNumber(0, (int) coveredDevicesIdx.size() - 1);
-            Device& device = devices.at(coveredDevicesIdx.at(idx));
+        inline Move generateNeighbor(Result& state, const iVec& coveredDevicesIdx, utils::Rng& rng, iVec& order) {
+            Move move;
+            int idx = utils::randomNumber(rng, 0, (int) coveredDevicesIdx.size() - 1);
+            Device& device = state.devices.at(coveredDevicesIdx.at(idx));
+            const CandidateTable& candidates = *state.candidates;
+            const int first = candidates.first(device.id);
             
-            iVec serversShuffled = utils::shuffledRange(0, (int) device.servers.size() - 1);
+            utils::shuffledRange(rng, 0, candidates.count(device.id) - 1, order);
             
             int tries = 0;
-            for (auto idxServers : serversShuffled) {
+            for (auto idxServers : order) {
                 if (tries++ >= 5) break;
-                auto& potential_server = device.servers.at(idxServers);
+                const int slot = first + idxServers;
+                const int serverId = candidates.serverIds[slot];
 
-                if (potential_server.id == device.server.id) continue;
+                if (serverId == device.server.id) continue;
 
-                Server& old_server = servers.at(device.server.id);
-                Server& new_server = servers.at(potential_server.id);
+                if (state.ledger.canServe(serverId, device)) {
+                    const server_covering potential_server = candidates.entry(device.id, slot);
+                    move.device = coveredDevicesIdx.at(idx);
+                    move.oldServer = state.ledger.assignment[device.id];
+                    move.newServer = serverId;
+                    move.delta += NetworkResourceAllocation::release(state, device);
+                    move.delta += NetworkResourceAllocation::assign(state, device, potential_server);
+                    return move;
+                }
+            }
+            return move;
+        }
 
-                if (new_server.canServe(device)) {
-                    if (!new_server.on) {
-                        csu += new_server.csc;
-                    }
+        /**
+         * @brief Rolls back a move previously applied by `generateNeighbor`.
+         * @param[in,out] state The solution to restore.
+         * @param[in] move The move to revert.
+         */
+        inline void undoMove(Result& state, const Move& move) {
+            if (move.device == 0) return;
+            Device& device = state.devices[move.device];
 
-                    if (device.served) {
-                        old_server.rmvServed(device);
-                        if (!old_server.on) {
-                            csu -= old_server.csc;
-                        }
-                    } else {
-                        cns -= device.cnd;
-                    }
+            NetworkResourceAllocation::release(state, device);
+            if (move.oldServer != 0) {
+                const CandidateTable& candidates = *state.candidates;
+                NetworkResourceAllocation::assign(state, device, candidates.entry(device.id, candidates.find(device.id, move.oldServer)));
+            }
+        }
 
-                    new_server.addServed(device);
-                    device.server = potential_server;
-                    return;
+        /**
+         * @brief Rewrites a solution in place so that it matches a saved assignment.
+         * @details Devices that must move are first released from their current server
+         * and then allocated to their target, so the intermediate state never
+         * double-counts a device on two servers.
+         * @param[in,out] state The solution to rewrite.
+         * @param[in] assignment Indexed by device; holds the target server id, or 0 if unserved.
+         */
+        inline void restoreAssignment(Result& state, const iVec& assignment) {
+            for (int d_idx : state.coveredDevicesIdx) {
+                if (state.ledger.assignment[d_idx] != assignment[d_idx]) {
+                    NetworkResourceAllocation::release(state, state.devices[d_idx]);
+                }
+            }
+            for (int d_idx : state.coveredDevicesIdx) {
+                int target = assignment[d_idx];
+                if (target != 0 && state.ledger.assignment[d_idx] != target) {
+                    NetworkResourceAllocation::assign(state, state.devices[d_idx], state.candidates->entry(d_idx, state.candidates->find(d_idx, target)));
                 }
             }
         }
     
+        /**
+         * @struct AnnealingChain
+         * @brief The resumable state of one Simulated Annealing run over a `Result`.
+         * @details Holds the temperature, the running costs and the best assignment found
+         * so far, so a chain can be advanced a few temperature levels at a time. This lets
+         * several chains run side by side and periodically share their best solution.
+         * Each chain owns its random number context and counts its neighbor moves. A chain
+         * may be restricted to a subset of the covered devices (a local repair).
+         *
+         * The `budget` bounds a chain by time, neighbors drawn, or temperature levels
+         * without a new best solution. With `budget.adaptive`, a level on which more than
+         * 60% of the worsening moves were accepted cools twice as fast (the walk is still
+         * random). When the chain freezes, or has found nothing new for `REHEAT_LEVELS`
+         * levels while accepting under 1% of the worsening moves, it is reheated to the
+         * initial temperature halved once per reheat so far. When that temperature is below
+         * the threshold, an unbounded chain freezes for good, while a chain with a time or
+         * iteration budget restarts the cycle of reheats from its best solution.
+         */
+        struct AnnealingChain {
+            static constexpr double FROZEN = 1e-3;   ///< Temperature at which the chain stops.
+            static constexpr int REHEAT_LEVELS = 25; ///< Levels without a new best before an adaptive chain may reheat.
+
+            Result& state;
+            const iVec& pool; ///< The devices the neighbors relocate.
+            utils::Rng rng;
+            double T;
+            double alpha;
+            SearchBudget budget;
+            iVec bestAssignment;
+            double bestCost;
+            iVec order; ///< Scratch space of `generateNeighbor`.
+            MetaHeuristicMetrics::SearchCounters search;
+
+            AnnealingChain(Result& state_, utils::Rng rng_, double T_, double alpha_, const iVec* pool_ = nullptr, SearchBudget budget_ = {})
+                : state(state_), pool(pool_ ? *pool_ : state_.coveredDevicesIdx), rng(rng_), T(T_), alpha(alpha_), budget(budget_),
+                  bestAssignment(state_.ledger.assignment), bestCost(state_.tracker.allocationCost()), initialT(T_) {
+                if (T <= FROZEN) search.stop_reason = "Frozen";
+            }
+
+            /**
+             * @brief The cost (non-service + servers used) of the chain's current solution.
+             */
+            inline double currentCost() const { return state.tracker.allocationCost(); }
+
+            /**
+             * @brief Checks whether the chain has stopped: frozen, out of budget or stagnant.
+             */
+            inline bool finished() const { return !search.stop_reason.empty(); }
+
+            /**
+             * @brief Advances the chain through a number of temperature levels.
+             * @details At each level, neighbors are generated and accepted with the Metropolis
+             * rule; an improving move restarts the level's inner counter. Neighbors are applied
+             * in place and undone when rejected. Every neighbor drawn is classified in `search`.
+             * The budget is checked before every neighbor, so a level may end early.
+             * @param[in] levels The number of temperature levels to run; 0 runs until `finished()`.
+             */
+            inline void run(int levels = 0) {
+                Profiling::ScopedTimer timer("SA::run", &search.search_sec, "search");
+                const MetaHeuristicMetrics::SearchCounters before = search;
+                runStart = Profiling::Clock::now();
+
+                for (int level = 0; !finished() && (levels <= 0 || level < levels); ++level) {
+                    uint64_t uphill = 0, uphillAccepted = 0;
+                    bool improved = false;
+                    for (int i = 0; i < 10; ++i) {
+                        if (outOfBudget()) break;
+                        Move move = generateNeighbor(state, pool, rng, order);
+                        ++search.iterations;
+                        if (move.device == 0) ++search.infeasible;
+
+                        if (move.delta < 0) {
+                            ++search.accepted;
+                            i = 0; // if accepted, persist in this interval
+
+                            if (currentCost() < bestCost) {
+                                bestCost = currentCost();
+                                bestAssignment = state.ledger.assignment;
+                                improved = true;
+                            }
+
+                        } else if (!(utils::randomNumber(rng, 0.0, 1.0) < std::exp(-move.delta / T))) {
+                            undoMove(state, move);
+                            ++search.rejected;
+                            ++uphill;
+                        } else if (move.device != 0) {
+                            ++search.accepted;
+                            ++uphill;
+                            ++uphillAccepted;
+                        }
+                    } 
+                    if (!finished()) endLevel(uphill, uphillAccepted, improved);
+                }
+
+                std::string args;
+                if (Profiling::Trace::global().enabled()) {
+                    args = "\"iterations\":" + std::to_string(search.iterations - before.iterations) +
+                           ",\"accepted\":" + std::to_string(search.accepted - before.accepted) +
+                           ",\"rejected\":" + std::to_string(search.rejected - before.rejected) +
+                           ",\"infeasible\":" + std::to_string(search.infeasible - before.infeasible);
+                }
+                state.metrics->outputs.execution_time_sec += timer.stop(std::move(args));
+            }
+
+        private:
+            double initialT;
+            int reheats = 0;
+            int levelsSinceBest = 0; ///< Temperature levels since the last new best solution.
+            int stuckLevels = 0;     ///< Like `levelsSinceBest`, but also reset by a reheat.
+            Profiling::Clock::time_point runStart;
+
+            /**
+             * @brief Stops the chain if its iteration or time budget is spent.
+             * @details The clock is read every 64 neighbors only.
+             */
+            inline bool outOfBudget() {
+                if (budget.maxIterations > 0 && search.iterations >= budget.maxIterations) {
+                    search.stop_reason = "Iterations";
+                } else if (budget.timeLimitSec > 0.0 && (search.iterations & 63) == 0 &&
+                           search.search_sec + std::chrono::duration<double>(Profiling::Clock::now() - runStart).count() >= budget.timeLimitSec) {
+                    search.stop_reason = "Time";
+                }
+                return finished();
+            }
+
+            /**
+             * @brief Closes a temperature level: checks stagnation, then cools (or reheats) the chain.
+             * @param[in] uphill The worsening moves drawn on the level.
+             * @param[in] uphillAccepted How many of them were accepted.
+             * @param[in] improved Whether the level found a new best solution.
+             */
+            inline void endLevel(uint64_t uphill, uint64_t uphillAccepted, bool improved) {
+                levelsSinceBest = improved ? 0 : levelsSinceBest + 1;
+                stuckLevels = improved ? 0 : stuckLevels + 1;
+                if (budget.stagnationLevels > 0 && levelsSinceBest >= budget.stagnationLevels) {
+                    search.stop_reason = "Stagnation";
+                    return;
+                }
+                if (!budget.adaptive) {
+                    T *= alpha;
+                    if (T <= FROZEN) search.stop_reason = "Frozen";
+                    return;
+                }
+
+                const double rate = uphill > 0 ? (double) uphillAccepted / uphill : 0.0;
+                T *= rate > 0.6 ? alpha * alpha : alpha;
+                if (T <= FROZEN || (stuckLevels >= REHEAT_LEVELS && rate < 0.01)) {
+                    T = initialT * std::pow(0.5, ++reheats);
+                    stuckLevels = 0;
+                    if (T > FROZEN) return;
+                    if (budget.timeLimitSec <= 0.0 && budget.maxIterations == 0) {
+                        search.stop_reason = "Frozen";
+                        return;
+                    }
+                    // A bounded chain spends its whole budget: start a new cycle of reheats from the best solution.
+                    restoreAssignment(state, bestAssignment);
+                    reheats = 1;
+                    T = initialT * 0.5;
+                }
+            }
+
+        public:
+            /**
+             * @brief Replaces the chain's current solution with an assignment from another chain.
+             * @param[in] assignment The per-device server assignment to adopt.
+             * @param[in] cost The cost (non-service + servers used) of that assignment.
+             */
+            inline void adopt(const iVec& assignment, double cost) {
+                restoreAssignment(state, assignment);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAssignment = assignment;
+                }
+            }
+
+            /**
+             * @brief Writes the best solution back into the state and recomputes its metrics.
+             */
+            inline void finish() {
+                Profiling::ScopedTimer timer("SA::finish", &state.metrics->outputs.execution_time_sec, "search");
+                restoreAssignment(state, bestAssignment);
+                timer.stop();
+
+                NetworkResourceAllocation::calculateMetrics(state, *state.metrics);
+            }
+        };
+
         /**
          * @brief Performs resource allocation using the Simulated Annealing (SA) meta-heuristic.
          * @details This function implements the SA algorithm to find a near-optimal allocation.
@@ -66,69 +332,416 @@ namespace MetaHeuristics {
          * escape local optima. The temperature is gradually decreased according to the
          * cooling rate `alpha`. The process stops when the temperature falls below a
          * minimum threshold.
+         * Neighbors are applied in place and undone when rejected; the best solution
+         * is tracked as a plain assignment vector and written back at the end.
          *
          * @param[in,out] state The Result object containing the initial solution. It is
          * updated in-place to hold the best solution found by the algorithm.
          * @param[in] T The initial temperature for the annealing process.
          * @param[in] alpha The cooling rate (e.g., 0.95), used to decrease the temperature.
+         * @param[in] rng The random number context the chain draws from.
+         * @param[in] budget When the chain stops besides freezing, and whether its schedule adapts.
+         */
+        inline void simulatedAnnealing(Result& state, double T, double alpha, utils::Rng rng, SearchBudget budget = {}) {
+            AnnealingChain chain(state, rng, T, alpha, nullptr, budget);
+            chain.run();
+            chain.finish();
+        }
+
+        /**
+         * @brief Shares the best solution of a group of chains with the chains lagging behind it.
+         * @details Every chain whose current cost is worse than the best cost found by any
+         * chain in the group restarts from that best assignment.
+         * @param[in,out] chains The chains running side by side.
          */
-        inline void simulatedAnnealing(Result& state, double T, double alpha) {
-            iVec& coveredDevicesIdx = state.coveredDevicesIdx;
-
-            Devices bestDevices = state.devices, currentDevices = state.devices;
-            Servers bestServers = state.servers, currentServers = state.servers;
-
-            double bestCNS = state.metrics->outputs.cost_of_non_service, currentCNS = bestCNS;
-            double bestCSU = state.metrics->outputs.cost_of_servers_used, currentCSU = bestCSU;
-            double bestCost = bestCNS + bestCSU, currentCost = bestCost;
-          
-            auto startChrono = std::chrono::high_resolution_clock::now();
-
-            while (T > 1e-3) {
-                for (int i = 0; i < 10; ++i) {
-                    Devices neighborDevices = currentDevices;
-                    Servers neighborServers = currentServers;
-                    double neighborCNS = currentCNS;
-                    double neighborCSU = currentCSU;
-                    
-                    generateNeighbor(neighborDevices, neighborServers, coveredDevicesIdx, neighborCNS, neighborCSU);
-                    
-                    double neighborCost = neighborCNS + neighborCSU;
-                    double delta = neighborCost - currentCost;
-
-                    if (delta < 0) {
-                        i = 0; // if accepted, persist in this interval
-                        currentCNS = neighborCNS;
-                        currentCSU = neighborCSU;
-                        currentCost = neighborCost;
-                        currentDevices = std::move(neighborDevices);
-                        currentServers = std::move(neighborServers);
-
-                        if (currentCost < bestCost) {
-                            bestCNS = currentCNS;
-                            bestCSU = currentCSU;
-                            bestCost = currentCost;
-                            bestDevices = currentDevices;
-                            bestServers = currentServers;
+        inline void exchangeBest(std::vector<AnnealingChain>& chains) {
+            size_t best = 0;
+            for (size_t c = 1; c < chains.size(); ++c) {
+                if (chains[c].bestCost < chains[best].bestCost) best = c;
+            }
+            for (size_t c = 0; c < chains.size(); ++c) {
+                if (c != best && chains[c].currentCost() > chains[best].bestCost) {
+                    chains[c].adopt(chains[best].bestAssignment, chains[best].bestCost);
+                }
+            }
+        }
+
+        /**
+         * @brief Anneals a group of chains side by side and writes back their best solutions.
+         * @param[in,out] chains The chains to run, one per thread.
+         * @param[in] threads The maximum number of threads to use.
+         * @param[in] exchangeInterval Temperature levels between best-solution exchanges (0 disables it).
+         * With exchanges, the result of a chain depends on which chains share its group.
+         */
+        inline void runChains(std::vector<AnnealingChain>& chains, unsigned threads, int exchangeInterval) {
+            if (chains.empty()) return;
+            if (exchangeInterval <= 0) {
+                Parallel::parallelFor(0, chains.size(), [&](size_t c) { chains[c].run(); }, threads, 1);
+            } else {
+                auto running = [&chains]() {
+                    return std::any_of(chains.begin(), chains.end(), [](const AnnealingChain& chain) { return !chain.finished(); });
+                };
+                while (running()) {
+                    Parallel::parallelFor(0, chains.size(), [&](size_t c) { chains[c].run(exchangeInterval); }, threads, 1);
+                    exchangeBest(chains);
+                }
+            }
+            Parallel::parallelFor(0, chains.size(), [&](size_t c) { chains[c].finish(); }, threads, 1);
+        }
+
+        /**
+         * @struct TabuSearch
+         * @brief A Tabu Search over relocate and swap moves, optionally iterated (ILS).
+         * @details Each iteration evaluates the moves of `sample` random covered devices and
+         * applies the best one that is not tabu, even when it makes the solution worse; a
+         * tabu move is still taken when it beats the best solution found (aspiration).
+         * Moved devices stay tabu for `tenure` iterations. The moves are:
+         * - relocate: a device goes to another candidate server with room for it, or an
+         *   unserved device is served;
+         * - swap: a device trades places with a device on a candidate server it does not fit
+         *   on. With a served device the cost is unchanged (a sideways move that frees room
+         *   elsewhere); with an unserved one, it replaces a device of lower CND.
+         *
+         * Relocation gains are cached per candidate slot, stamped with a version of the
+         * device's current server and of the target server. A server's version changes
+         * when its load does, so only the gains involving it are recomputed, and checking
+         * an entry is O(1). Moves go through `NetworkResourceAllocation::assign` and
+         * `release`, so costs come from the objective tracker and no state is copied.
+         *
+         * The plain Tabu Search ends after `stall` iterations without improvement. As an
+         * ILS, each such phase ends in a local optimum that is accepted as the new starting
+         * point if it is better, or otherwise with the Metropolis probability at
+         * temperature `T`, which then cools by `alpha`. The next phase starts from the
+         * accepted point after `kicks` random relocations, until `iterations` run out.
+         * The time limit of the `SearchBudget` ends either search early.
+         */
+        struct TabuSearch {
+            Result& state;
+            utils::Rng rng;
+            double T;
+            double alpha;
+            bool iterated; ///< Run as an ILS (perturb and restart) rather than a single tabu phase.
+            TabuOptions options;
+            SearchBudget budget;
+            iVec bestAssignment;
+            double bestCost;
+            MetaHeuristicMetrics::SearchCounters search;
+
+            TabuSearch(Result& state_, utils::Rng rng_, double T_, double alpha_, bool iterated_, TabuOptions options_ = {}, SearchBudget budget_ = {})
+                : state(state_), rng(rng_), T(T_), alpha(alpha_), iterated(iterated_), options(options_), budget(budget_), bestAssignment(state_.ledger.assignment),
+                  bestCost(state_.tracker.allocationCost()), version(state_.servers.size(), 0), tabuUntil(state_.devices.size(), 0),
+                  gains(state_.candidates->serverIds.size()), members(state_.servers.size()), position(state_.devices.size(), -1) {
+                const int n = (int) state.coveredDevicesIdx.size();
+                if (budget.maxIterations > 0) options.iterations = (int) std::min<uint64_t>(budget.maxIterations, std::numeric_limits<int>::max());
+                if (options.iterations <= 0) options.iterations = 20 * n;
+                if (options.stall <= 0) options.stall = std::max(200, n);
+                if (options.tenure <= 0) options.tenure = std::max(5, (int) std::sqrt((double) n));
+                if (options.sample <= 0) options.sample = 1;
+                if (options.kicks <= 0) options.kicks = std::max(3, n / 50);
+                rebuildMembers();
+            }
+
+            inline double currentCost() const { return state.tracker.allocationCost(); }
+
+            /**
+             * @brief Runs the search until its budget is spent, keeping the best solution found.
+             */
+            inline void run() {
+                Profiling::ScopedTimer timer(iterated ? "ILS::run" : "Tabu::run", &search.search_sec, "search");
+                runStart = Profiling::Clock::now();
+                if (state.coveredDevicesIdx.empty()) search.stop_reason = "Stagnation";
+                else {
+                    iVec home = state.ledger.assignment;
+                    double homeCost = currentCost();
+                    while (search.stop_reason.empty()) {
+                        const double phaseCost = tabuPhase();
+                        if (!iterated) break;
+                        if (!search.stop_reason.empty()) break;
+
+                        // Phase ended in its best solution's neighborhood: accept or reject that local optimum.
+                        if (phaseCost < homeCost || utils::randomNumber(rng, 0.0, 1.0) < std::exp(-(phaseCost - homeCost) / T)) {
+                            home = phaseAssignment;
+                            homeCost = phaseCost;
+                        } else {
+                            ++search.rejected_optima;
                         }
+                        T = std::max(T * alpha, 1e-9);
+                        restoreAssignment(state, home);
+                        rebuildMembers();
+                        for (int k = 0; k < options.kicks; ++k) kick();
+                    }
+                }
+
+                std::string args;
+                if (Profiling::Trace::global().enabled()) {
+                    args = "\"iterations\":" + std::to_string(search.iterations) + ",\"accepted\":" + std::to_string(search.accepted) +
+                           ",\"rejected_optima\":" + std::to_string(search.rejected_optima) + ",\"infeasible\":" + std::to_string(search.infeasible);
+                }
+                state.metrics->outputs.execution_time_sec += timer.stop(std::move(args));
+            }
+
+            /**
+             * @brief Writes the best solution back into the state and recomputes its metrics.
+             */
+            inline void finish() {
+                Profiling::ScopedTimer timer(iterated ? "ILS::finish" : "Tabu::finish", &state.metrics->outputs.execution_time_sec, "search");
+                restoreAssignment(state, bestAssignment);
+                timer.stop();
+
+                NetworkResourceAllocation::calculateMetrics(state, *state.metrics);
+            }
+
+        private:
+            static constexpr double NO_MOVE = std::numeric_limits<double>::infinity();
+
+            /// A cached relocation gain, valid while both servers keep the stamped versions.
+            struct Gain {
+                double delta = NO_MOVE;
+                int source = -1;              ///< Server the device was on (0 if unserved, -1 if never computed).
+                uint32_t sourceVersion = 0;
+                uint32_t targetVersion = 0;
+            };
+
+            /// The best move of an iteration: `device` goes to `slot` (-1: becomes unserved), after `partner` goes to `partnerSlot`.
+            struct Candidate {
+                double delta = NO_MOVE;
+                int device = 0;
+                int slot = -1;
+                int partner = 0;
+                int partnerSlot = -1;
+            };
+
+            std::vector<uint32_t> version; ///< Bumped whenever a server's load changes.
+            std::vector<uint64_t> tabuUntil; ///< Iteration until which each device may not move.
+            std::vector<Gain> gains;       ///< Per candidate slot.
+            std::vector<iVec> members;     ///< Devices on each server.
+            iVec position;                 ///< Position of each device in its server's `members`.
+            iVec phaseAssignment;
+            Profiling::Clock::time_point runStart;
+
+            /**
+             * @brief Records why the search must stop, if its iteration or time budget is spent.
+             * @details The clock is read every 64 iterations only.
+             */
+            inline bool outOfBudget() {
+                if ((int) search.iterations >= options.iterations) {
+                    search.stop_reason = "Iterations";
+                } else if (budget.timeLimitSec > 0.0 && (search.iterations & 63) == 0 &&
+                           std::chrono::duration<double>(Profiling::Clock::now() - runStart).count() >= budget.timeLimitSec) {
+                    search.stop_reason = "Time";
+                }
+                return !search.stop_reason.empty();
+            }
+
+            inline void rebuildMembers() {
+                for (iVec& list : members) list.clear();
+                for (int d : state.coveredDevicesIdx) {
+                    const int j = state.ledger.assignment[d];
+                    position[d] = j != 0 ? (int) members[j].size() : -1;
+                    if (j != 0) members[j].push_back(d);
+                }
+                for (uint32_t& v : version) ++v;
+            }
+
+            /**
+             * @brief Moves a device to a candidate slot, or leaves it unserved (`slot` -1).
+             * @return The resulting change in cost.
+             */
+            inline double moveTo(int d, int slot) {
+                Device& device = state.devices[d];
+                double delta = 0.0;
+                const int from = state.ledger.assignment[d];
+                if (from != 0) {
+                    iVec& list = members[from];
+                    position[list.back()] = position[d];
+                    list[position[d]] = list.back();
+                    list.pop_back();
+                    position[d] = -1;
+                    delta += NetworkResourceAllocation::release(state, device);
+                    ++version[from];
+                }
+                if (slot >= 0) {
+                    const int to = state.candidates->serverIds[slot];
+                    delta += NetworkResourceAllocation::assign(state, device, state.candidates->entry(device.id, slot));
+                    position[d] = (int) members[to].size();
+                    members[to].push_back(d);
+                    ++version[to];
+                }
+                return delta;
+            }
+
+            /**
+             * @brief The change in cost of relocating a device to a candidate slot, from the cache when still valid.
+             */
+            inline double relocationGain(int d, int slot) {
+                const int from = state.ledger.assignment[d];
+                const int to = state.candidates->serverIds[slot];
+                Gain& gain = gains[slot];
+                if (gain.source == from && gain.sourceVersion == version[from] && gain.targetVersion == version[to]) return gain.delta;
+
+                const Device& device = state.devices[d];
+                double delta = NO_MOVE;
+                if (to != from && state.ledger.canServe(to, device)) {
+                    delta = from == 0 ? -device.cnd : (state.ledger.load[from] == 1 ? -state.servers[from].csc : 0.0);
+                    if (!state.servers[to].on) delta += state.servers[to].csc;
+                }
+                gain = {delta, from, version[from], version[to]};
+                return delta;
+            }
+
+            /// Whether `entering` fits on server `j` once `leaving` has left it.
+            inline bool fitsInstead(int j, const Device& leaving, const Device& entering) const {
+                const CapacityLedger& ledger = state.ledger;
+                return (entering.pcc <= ledger.pcc[j] + leaving.pcc) & (entering.pcn <= ledger.pcn[j] + leaving.pcn) &
+                       (entering.mem <= ledger.mem[j] + leaving.mem) & (entering.sto <= ledger.sto[j] + leaving.sto) &
+                       (entering.bw <= ledger.bw[j] + leaving.bw);
+            }
 
-                    } else if (utils::randomNumber(0.0, 1.0) < std::exp(-delta / T)) {
-                        currentCNS = neighborCNS;
-                        currentCSU = neighborCSU;
-                        currentCost = neighborCost;
-                        currentDevices = std::move(neighborDevices);
-                        currentServers = std::move(neighborServers);
+            /**
+             * @brief Evaluates the relocations and swaps of one device, keeping the best admissible one in `best`.
+             */
+            inline void evaluate(int d, Candidate& best) {
+                const CandidateTable& candidates = *state.candidates;
+                const Device& device = state.devices[d];
+                const int from = state.ledger.assignment[d];
+                const double aspiration = bestCost - currentCost() - 1e-9;
+                const bool tabu = tabuUntil[d] > search.iterations;
+                auto consider = [&](double delta, bool isTabu, const Candidate& move) {
+                    if (delta < best.delta && (!isTabu || delta < aspiration)) {
+                        best = move;
+                        best.delta = delta;
                     }
-                } 
-                T *= alpha;
+                };
+
+                for (int slot = candidates.first(d); slot < candidates.last(d); ++slot) {
+                    const double delta = relocationGain(d, slot);
+                    if (delta != NO_MOVE) {
+                        consider(delta, tabu, {0.0, d, slot, 0, -1});
+                        continue;
+                    }
+                    const int to = candidates.serverIds[slot];
+                    if (to == from || state.ledger.load[to] == 0) continue;
+
+                    const iVec& list = members[to];
+                    const int partner = list[utils::randomNumber(rng, 0, (int) list.size() - 1)];
+                    const Device& other = state.devices[partner];
+                    if (!fitsInstead(to, other, device)) continue;
+                    const bool partnerTabu = tabu || tabuUntil[partner] > search.iterations;
+                    if (from == 0) {
+                        consider(other.cnd - device.cnd, partnerTabu, {0.0, d, slot, partner, -1});
+                    } else {
+                        const int back = candidates.find(partner, from);
+                        if (back >= 0 && fitsInstead(from, device, other)) consider(0.0, partnerTabu, {0.0, d, slot, partner, back});
+                    }
+                }
             }
-            auto endChrono = std::chrono::high_resolution_clock::now();
-            state.metrics->outputs.execution_time_sec += std::chrono::duration<double>(endChrono - startChrono).count();
 
-            NetworkResourceAllocation::calculateMetrics(bestDevices, bestServers, *state.metrics);
-        }
+            /**
+             * @brief Runs tabu iterations until `stall` of them bring no improvement or the budget is spent.
+             * @details A plain Tabu Search that stalls records "Stagnation" as its stopping reason.
+             * @return The cost of the best solution of the phase, saved in `phaseAssignment`.
+             */
+            inline double tabuPhase() {
+                const iVec& pool = state.coveredDevicesIdx;
+                phaseAssignment = state.ledger.assignment;
+                double phaseCost = currentCost();
+                int stalled = 0;
+                while (!outOfBudget()) {
+                    if (stalled >= options.stall) {
+                        if (!iterated) search.stop_reason = "Stagnation";
+                        break;
+                    }
+                    ++search.iterations;
+                    Candidate best;
+                    for (int s = 0; s < options.sample; ++s) evaluate(pool[utils::randomNumber(rng, 0, (int) pool.size() - 1)], best);
+                    if (best.delta == NO_MOVE) {
+                        ++search.infeasible;
+                        ++stalled;
+                        continue;
+                    }
+
+                    ++search.accepted;
+                    const uint64_t until = search.iterations + options.tenure;
+                    tabuUntil[best.device] = until;
+                    if (best.partner != 0) {
+                        tabuUntil[best.partner] = until;
+                        // Free both places first, so neither device is ever counted on two servers.
+                        moveTo(best.partner, -1);
+                        if (best.partnerSlot >= 0) {
+                            moveTo(best.device, -1);
+                            moveTo(best.partner, best.partnerSlot);
+                        }
+                        moveTo(best.device, best.slot);
+                    } else {
+                        moveTo(best.device, best.slot);
+                    }
+
+                    if (currentCost() < phaseCost - 1e-9) {
+                        phaseCost = currentCost();
+                        phaseAssignment = state.ledger.assignment;
+                        stalled = 0;
+                        if (phaseCost < bestCost) {
+                            bestCost = phaseCost;
+                            bestAssignment = phaseAssignment;
+                        }
+                    } else {
+                        ++stalled;
+                    }
+                }
+                return phaseCost;
+            }
+
+            /**
+             * @brief Relocates a random covered device to a random candidate server with room for it.
+             */
+            inline void kick() {
+                const iVec& pool = state.coveredDevicesIdx;
+                const CandidateTable& candidates = *state.candidates;
+                const int d = pool[utils::randomNumber(rng, 0, (int) pool.size() - 1)];
+                const int count = candidates.count(d);
+                if (count == 0) return;
+                const int start = utils::randomNumber(rng, 0, count - 1);
+                for (int k = 0; k < count; ++k) {
+                    const int slot = candidates.first(d) + (start + k) % count;
+                    const int to = candidates.serverIds[slot];
+                    if (to != state.ledger.assignment[d] && state.ledger.canServe(to, state.devices[d])) {
+                        moveTo(d, slot);
+                        return;
+                    }
+                }
+            }
+        };
     }   
 
+    /**
+     * @brief Runs a meta-heuristic once on a state without displaying or saving its metrics.
+     * @details The state must already hold an initial solution (e.g., from `Heuristics::run`),
+     * which is improved in place. Used when a meta-heuristic solution seeds another
+     * solver, such as the CPLEX warm start.
+     *
+     * @param[in] algorithm_name The meta-heuristic algorithm to run: "SA", "Tabu" or "ILS".
+     * @param[in,out] state The solution to improve in place.
+     * @param[in] T The initial temperature for Simulated Annealing (and the ILS acceptance rule).
+     * @param[in] alpha The cooling rate for Simulated Annealing (and the ILS acceptance rule).
+     * @param[in] rng The random number context the search draws from.
+     * @param[in] budget When the search stops (time, iterations, stagnation) and whether SA adapts its schedule.
+     * @param[in] tabu The tenure, sample, stall and kick settings of "Tabu" and "ILS".
+     * @return `true` if the algorithm name is known and the meta-heuristic ran, `false` otherwise.
+     */
+    inline bool run(const std::string& algorithm_name, Result& state, double T, double alpha, const utils::Rng& rng, SearchBudget budget = {}, TabuOptions tabu = {}) {
+        if (algorithm_name == "SA") {
+            simulatedAnnealing(state, T, alpha, rng, budget);
+        } else if (algorithm_name == "Tabu" || algorithm_name == "ILS") {
+            TabuSearch search(state, rng, T, alpha, algorithm_name == "ILS", tabu, budget);
+            search.run();
+            search.finish();
+        } else {
+            std::cerr << "Error: Unknown simulation or algorithm type." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
     /**
      * @brief Manages the execution of a meta-heuristic algorithm for a specified number of runs.
      * @details This function orchestrates the entire meta-heuristic process. It first
@@ -136,61 +749,108 @@ namespace MetaHeuristics {
      * "Greedy"). It then runs the selected meta-heuristic (e.g., "SA") starting from
      * that solution. The entire process (initial solution generation + meta-heuristic
      * optimization) is repeated `loopTest` times to gather statistical data.
+     * Repetitions run in groups of `threads` chains, one chain per thread. Repetition
+     * `r` draws from stream `r + 1` of `rng`, so every row can be replayed from the
+     * seed and stream recorded in its metrics, whatever the thread count. When `exchangeInterval` is positive, the
+     * chains of a group advance in lockstep and share their best assignment every
+     * `exchangeInterval` temperature levels (SA only). A repetition then also depends on
+     * the other chains of its group, which `threads` and `firstRepetition` decide, so such
+     * runs only replay with the same thread count and without resuming. Metrics rows are emitted in repetition order.
+     * The working copies of a group live in a `StatePool` created once: each repetition
+     * restores its slot from the base state in place, retaining no memory across repetitions.
      *
-     * @param[in] algorithm_name The meta-heuristic algorithm to run (e.g., "SA").
-     * @param[in] state The initial state from the pre-calculation phase. This object is
-     * copied for each run and is NOT modified by this function.
-     * @param[in] T The initial temperature for Simulated Annealing.
-     * @param[in] alpha The cooling rate for Simulated Annealing.
+     * @param[in] algorithm_name The meta-heuristic algorithm to run: "SA", "Tabu" or "ILS".
+     * @param[in] state The initial state from the pre-calculation phase. It is copied
+     * once per concurrent chain and is NOT modified by this function.
+     * @param[in] T The initial temperature for Simulated Annealing (and the ILS acceptance rule).
+     * @param[in] alpha The cooling rate for Simulated Annealing (and the ILS acceptance rule).
      * @param[in] heuristic_used The heuristic to generate the initial solution.
      * @param[in] loopTest The number of independent times to run the full process.
+     * @param[in] rng The random number context whose seed all repetitions derive from.
+     * @param[in] threads The number of chains to run concurrently.
+     * @param[in] exchangeInterval Temperature levels between best-solution exchanges (0 disables it).
+     * @param[in] firstRepetition The first repetition to run; earlier ones (and the report of a
+     * deterministic initial heuristic) are skipped, to resume an interrupted series.
+     * @param[in] budget When each repetition stops (time, iterations, stagnation) and whether SA adapts its schedule.
+     * @param[in] tabu The tenure, sample, stall and kick settings of "Tabu" and "ILS".
      */
-    inline void bootup(const std::string& algorithm_name, const Result& state, double T, double alpha, const std::string& heuristic_used, int loopTest) {
-        
+    inline void bootup(const std::string& algorithm_name, const Result& state, double T, double alpha, const std::string& heuristic_used, int loopTest, const utils::Rng& rng,
+                       unsigned threads = Parallel::defaultThreads(), int exchangeInterval = 0, int firstRepetition = 0, SearchBudget budget = {},
+                       TabuOptions tabu = {}) {
+        if (algorithm_name != "SA" && algorithm_name != "Tabu" && algorithm_name != "ILS") {
+            std::cerr << "Error: Unknown simulation or algorithm type." << std::endl;
+            return;
+        }
+        if (!state.metrics) {
+            std::cerr << "Error: Metrics not available." << std::endl;
+            return;
+        }
+
+        const std::optional<Heuristics::Algorithm> heuristic = Heuristics::resolve(heuristic_used);
+        if (!heuristic) return;
+        const bool annealing = algorithm_name == "SA";
+        const bool iterated = algorithm_name == "ILS";
         Result baseState = state;
-        
-        if (heuristic_used == "Random") {
-            for (int i = 0; i < loopTest; ++i) {
-                Result iteration = baseState;
-                Heuristics::bootup(heuristic_used, iteration);
-
-                if (algorithm_name == "SA") {
-                    simulatedAnnealing(iteration, T, alpha);
-                } else {
-                    std::cerr << "Error: Unknown simulation or algorithm type." << std::endl;
-                    return;
-                }
 
-                if (state.metrics) {
-                    auto metrics = std::make_unique<MetaHeuristicMetrics>("MetaHeuristic", algorithm_name, iteration.metrics, T, alpha, heuristic_used);
-                    showStructs::showMetrics(*metrics);
-                    metrics->saveResultsToFile();
-                } else {
-                    std::cerr << "Error: Metrics not available." << std::endl;
-                    return;
-                }
+        // A random initial solution is drawn per repetition; other heuristics are deterministic and run once.
+        const bool perChainHeuristic = (heuristic_used == "Random");
+        if (!perChainHeuristic) {
+            utils::Rng heuristicRng = rng.split(0);
+            Heuristics::run(*heuristic, baseState, heuristicRng);
+            if (firstRepetition <= 0) Heuristics::report(heuristic_used, baseState.metrics);
+        }
+
+        const int groupSize = std::max(1, (int) std::min<unsigned>(std::max(threads, 1u), (unsigned) std::max(loopTest - firstRepetition, 1)));
+        StatePool pool(baseState, groupSize);
+        std::vector<utils::Rng> streams;
+        streams.reserve(groupSize);
+        std::vector<std::unique_ptr<Metrics>> initialMetrics(groupSize);
+        if (perChainHeuristic) {
+            for (auto& metrics : initialMetrics) metrics = baseState.metrics->clone();
+        }
+        std::vector<MetaHeuristicMetrics> reports(groupSize, MetaHeuristicMetrics("MetaHeuristic", algorithm_name, baseState.metrics, T, alpha, heuristic_used));
+        std::vector<MetaHeuristicMetrics::SearchCounters> counters(groupSize);
+
+        for (int first = std::max(firstRepetition, 0); first < loopTest; first += groupSize) {
+            const int count = std::min(groupSize, loopTest - first);
+            streams.clear();
+            for (int c = 0; c < count; ++c) {
+                Result& iteration = pool.reset(c);
+                streams.push_back(rng.split(first + c + 1));
+                iteration.metrics->inputs.seed = rng.seed();
+                iteration.metrics->inputs.stream = first + c + 1;
             }
-        } else {
-            Heuristics::bootup(heuristic_used, baseState);
-            
-            for (int i = 0; i < loopTest; ++i) {
-                Result iteration = baseState;
 
-                if (algorithm_name == "SA") {
-                    simulatedAnnealing(iteration, T, alpha);
-                } else {
-                    std::cerr << "Error: Unknown simulation or algorithm type." << std::endl;
-                    return;
-                }
+            if (perChainHeuristic) {
+                Parallel::parallelFor(0, count, [&](size_t c) {
+                    Heuristics::run(*heuristic, pool[c], streams[c]);
+                    initialMetrics[c]->copyResults(*pool[c].metrics);
+                }, threads, 1);
+            }
 
-                if (state.metrics) {
-                    auto metrics = std::make_unique<MetaHeuristicMetrics>("MetaHeuristic", algorithm_name, iteration.metrics, T, alpha, heuristic_used);                    
-                    showStructs::showMetrics(*metrics);
-                    metrics->saveResultsToFile();
-                } else {
-                    std::cerr << "Error: Metrics not available." << std::endl;
-                    return;
-                }
+            if (annealing) {
+                std::vector<AnnealingChain> chains;
+                chains.reserve(count);
+                for (int c = 0; c < count; ++c) chains.emplace_back(pool[c], streams[c], T, alpha, nullptr, budget);
+
+                runChains(chains, threads, exchangeInterval);
+                for (int c = 0; c < count; ++c) counters[c] = chains[c].search;
+            } else {
+                Parallel::parallelFor(0, count, [&](size_t c) {
+                    TabuSearch search(pool[c], streams[c], T, alpha, iterated, tabu, budget);
+                    search.run();
+                    search.finish();
+                    counters[c] = search.search;
+                }, threads, 1);
+            }
+
+            for (int c = 0; c < count; ++c) {
+                if (perChainHeuristic) Heuristics::report(heuristic_used, initialMetrics[c]);
+                MetaHeuristicMetrics& metrics = reports[c];
+                metrics.copyResults(*pool[c].metrics);
+                metrics.search = counters[c];
+                showStructs::showMetrics(metrics);
+                metrics.saveResultsToFile();
             }
         }
     }
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "DataGenerator.h"
+#include "Parallel.h"
+#include "Profiling.h"
+#include "Snapshot.h"
+#include "SpatialIndex.h"
 #include "structs.h"
 #include "utils.h"
 
@@ -8,99 +12,136 @@
 
 namespace NetworkResourceAllocation {
 
+    /**
+     * @brief Parses space-delimited device rows directly into Device structs.
+     * @details Fields are converted in place with `std::from_chars`; no intermediate
+     * strings are built. Rows whose first field is "#" (headers) are skipped, and rows
+     * that cannot be parsed are reported and skipped.
+     *
+     * @param[in] text The file content: `# LAT LON CND PCC PCN MEM STO S_d SVC` per row.
+     * @param[in,out] devices The vector the parsed devices are appended to.
+     */
+    inline void parseDevices(std::string_view text, Devices& devices) {
+        FileManager::FieldCursor cursor(text);
+        int line = 0;
+        while (cursor.nextRow()) {
+            ++line;
+            std::string_view first = cursor.field();
+            if (first == "#") { cursor.skipLine(); continue; }
+
+            int id, pcn, svc;
+            double lat, lon, cnd, pcc, mem, sto, s_d;
+            bool ok = std::from_chars(first.data(), first.data() + first.size(), id).ec == std::errc();
+            ok = ok && cursor.next(lat) && cursor.next(lon) && cursor.next(cnd) && cursor.next(pcc) && cursor.next(pcn)
+                    && cursor.next(mem) && cursor.next(sto) && cursor.next(s_d) && cursor.next(svc);
+            if (ok) {
+                devices.emplace_back(id, lat, lon, cnd, pcc, pcn, mem, sto, s_d, svc);
+            } else {
+                std::cerr << "Error parsing device data: malformed row " << line << std::endl;
+            }
+            cursor.skipLine();
+        }
+    }
+
+    /**
+     * @brief Parses space-delimited server rows directly into Server structs.
+     * @details Same conventions as `parseDevices`.
+     *
+     * @param[in] text The file content: `# LAT LON CSC PCC PCN MEM STO T_p` per row.
+     * @param[in] type The type of every server in the file ('E' for Edge, 'C' for Cloud).
+     * @param[in,out] servers The vector the parsed servers are appended to.
+     */
+    inline void parseServers(std::string_view text, char type, Servers& servers) {
+        FileManager::FieldCursor cursor(text);
+        int line = 0;
+        while (cursor.nextRow()) {
+            ++line;
+            std::string_view first = cursor.field();
+            if (first == "#") { cursor.skipLine(); continue; }
+
+            int id, pcn;
+            double lat, lon, csc, pcc, mem, sto, t_p;
+            bool ok = std::from_chars(first.data(), first.data() + first.size(), id).ec == std::errc();
+            ok = ok && cursor.next(lat) && cursor.next(lon) && cursor.next(csc) && cursor.next(pcc) && cursor.next(pcn)
+                    && cursor.next(mem) && cursor.next(sto) && cursor.next(t_p);
+            if (ok) {
+                servers.emplace_back(id, lat, lon, csc, pcc, pcn, mem, sto, t_p, type);
+            } else {
+                std::cerr << "Error parsing server data: malformed row " << line << std::endl;
+            }
+            cursor.skipLine();
+        }
+    }
+
     /**
      * @brief Loads or generates device data and parses it into a vector of Device structs.
-     * @details This function calls `DataGenerator::devicesData` to get the raw string data,
-     * then parses each row into a `Device` object. The returned vector is 1-indexed,
-     * with the element at index 0 being a default-constructed placeholder. It includes
-     * error handling to skip rows that cannot be parsed correctly.
+     * @details If the cached device file does not exist yet, it is generated first by
+     * `DataGenerator::devicesData`. The file is then memory-mapped and parsed in place by
+     * `parseDevices`. The returned vector is 1-indexed, with the element at index 0 being
+     * a default-constructed placeholder. Rows that cannot be parsed are skipped.
      *
      * @param[in] length The number of devices to load or generate.
+     * @param[in,out] rng The random number context used if the data must be generated.
      * @return A 1-indexed `std::vector<Device>`. Returns an empty vector on failure
      * (e.g., if the data file cannot be found or is empty).
      */
-    inline Devices loadDevices(int length) {
-        std::vector<std::vector<std::string>> strDevices = DataGenerator::devicesData(length);
-        if (strDevices.size() <= 1) {
-            std::cerr << "Error: Device data file not found or is empty." << std::endl;
-            return {};
-        }
+    inline Devices loadDevices(int length, utils::Rng& rng) {
+        const std::filesystem::path path = DataGenerator::devicesFile(length);
+        if (!std::filesystem::exists(path)) DataGenerator::devicesData(length, rng);
 
         Devices devices;
         devices.reserve(length + 1);
         devices.emplace_back(); // Placeholder for 1-based indexing.
-        
-        for (const auto& row : strDevices) {
-            if (row.at(0) == "#") continue;
-            try {
-                devices.emplace_back(
-                    std::stoi(row.at(0)),  // #: id
-                    std::stod(row.at(1)),  // LAT: lat
-                    std::stod(row.at(2)),  // LON: lon
-                    std::stod(row.at(3)),  // CND: cnd
-                    std::stod(row.at(4)),  // PCC: pcc
-                    std::stoi(row.at(5)),  // PCN: pcn
-                    std::stod(row.at(6)),  // MEM: mem
-                    std::stod(row.at(7)),  // STO: sto
-                    std::stod(row.at(8)),  // S_d: s_d
-                    std::stoi(row.at(9))   // SVC: svc
-                );
-            } catch (const std::exception& e) {
-                std::cerr << "Error parsing device data: " << e.what() << std::endl;
-                // Continue to next row
-            }
+
+        if (std::filesystem::exists(path)) {
+            FileManager::MappedFile file(path.string());
+            if (file.isOpen()) parseDevices(file.view(), devices);
+        }
+        if (devices.size() <= 1) {
+            std::cerr << "Error: Device data file not found or is empty." << std::endl;
+            return {};
         }
         return devices;
     }
     
     /**
      * @brief Loads or generates server data (EC and CC) into a single vector of Server structs.
-     * @details Fetches data for both Edge and Cloud servers using the `DataGenerator`. It then
-     * parses and combines them into a single 1-indexed `Servers` vector, assigning a `type`
-     * character ('E' for Edge, 'C' for Cloud) to each server during parsing.
+     * @details Ensures the cached Edge and Cloud server files exist (generating them with
+     * the `DataGenerator` if needed), then memory-maps and parses both into a single
+     * 1-indexed `Servers` vector, assigning a `type` character ('E' for Edge, 'C' for
+     * Cloud) to each server during parsing.
      *
      * @param[in] ecLength The number of EC servers to load.
      * @param[in] ccLength The number of CC servers to load.
+     * @param[in,out] rng The random number context used if the data must be generated.
      * @return A 1-indexed `std::vector<Server>` containing both server types. Returns
      * an empty vector on failure.
      */
-    inline Servers loadServers(int ecLength, int ccLength = 5) {
-        std::vector<std::vector<std::string>> strServerEC = DataGenerator::ecData(ecLength);
-        std::vector<std::vector<std::string>> strServerCC = DataGenerator::ccData(ccLength);
-        if (strServerEC.size() <= 1 || strServerCC.size() <= 1) {
-            std::cerr << "Error: Server data file(s) not found or are empty." << std::endl;
-            return {};
-        }
+    inline Servers loadServers(int ecLength, int ccLength, utils::Rng& rng) {
+        const std::filesystem::path ecPath = DataGenerator::ecFile(ecLength);
+        const std::filesystem::path ccPath = DataGenerator::ccFile(ccLength);
+        if (!std::filesystem::exists(ecPath)) DataGenerator::ecData(ecLength, rng);
+        if (!std::filesystem::exists(ccPath)) DataGenerator::ccData(ccLength);
 
         Servers servers;
         servers.reserve(ecLength + ccLength + 1);
         servers.emplace_back(); // Placeholder for 1-based indexing.
 
-        auto parseAndAdd = [&](const std::vector<std::vector<std::string>>& matrix, char type) {
-            for (const auto& row : matrix) {
-                if (row.at(0) == "#") continue;
-                try {
-                    servers.emplace_back(
-                        std::stoi(row.at(0)),  // #: id
-                        std::stod(row.at(1)),  // LAT: lat
-                        std::stod(row.at(2)),  // LON: lon
-                        std::stod(row.at(3)),  // CSC: csc
-                        std::stod(row.at(4)),  // PCC: pcc
-                        std::stoi(row.at(5)),  // PCN: pcn
-                        std::stod(row.at(6)),  // MEM: mem
-                        std::stod(row.at(7)),  // STO: sto
-                        std::stod(row.at(8)),  // T_p: t_p
-                        type
-                    );
-                } catch (const std::exception& e) {
-                    std::cerr << "Error parsing server data: " << e.what() << std::endl;
-                }
+        auto parseFile = [&](const std::filesystem::path& path, char type) {
+            const size_t before = servers.size();
+            if (std::filesystem::exists(path)) {
+                FileManager::MappedFile file(path.string());
+                if (file.isOpen()) parseServers(file.view(), type, servers);
             }
+            return servers.size() > before;
         };
 
-        parseAndAdd(strServerEC, 'E');
-        parseAndAdd(strServerCC, 'C');
-        
+        const bool ecLoaded = parseFile(ecPath, 'E');
+        const bool ccLoaded = parseFile(ccPath, 'C');
+        if (!ecLoaded || !ccLoaded) {
+            std::cerr << "Error: Server data file(s) not found or are empty." << std::endl;
+            return {};
+        }
         return servers;
     }    
 
@@ -111,7 +152,7 @@ namespace NetworkResourceAllocation {
      * @return A `std::vector<int>` containing the sorted indices.
      */
     inline iVec devicesAsc(const Devices& devices) {
-        return utils::sortEntities<true, Device, const double, &Device::cnd>(devices);
+        return utils::sortEntities<true, Device, const Real, &Device::cnd>(devices);
     }
 
     /**
@@ -121,7 +162,7 @@ namespace NetworkResourceAllocation {
      * @return A `std::vector<int>` containing the sorted indices.
      */
     inline iVec devicesDesc(const Devices& devices) {
-        return utils::sortEntities<false, Device, const double, &Device::cnd>(devices);
+        return utils::sortEntities<false, Device, const Real, &Device::cnd>(devices);
     }
 
     /**
@@ -131,7 +172,7 @@ namespace NetworkResourceAllocation {
      * @return A `std::vector<int>` containing the sorted indices.
      */
     inline iVec serversAsc(const Servers& servers) {
-        return utils::sortEntities<true, Server, const double, &Server::csc>(servers);
+        return utils::sortEntities<true, Server, const Real, &Server::csc>(servers);
     }
 
     /**
@@ -141,7 +182,7 @@ namespace NetworkResourceAllocation {
      * @return A `std::vector<int>` containing the sorted indices.
      */
     inline iVec serversDesc(const Servers& servers) {
-        return utils::sortEntities<false, Server, const double, &Server::csc>(servers);
+        return utils::sortEntities<false, Server, const Real, &Server::csc>(servers);
     }
 
     /**
@@ -201,96 +242,151 @@ namespace NetworkResourceAllocation {
 
     /**
      * @brief Identifies which devices are within coverage range of edge servers.
-     * @details Iterates through all device-server pairs. If a device is within the
-     * coverage radius of an edge server, it is marked as `covered` and that server
-     * is added to its list of potential servers. Cloud servers are added as potential
-     * servers for all covered devices. The cost of non-coverage is calculated for
+     * @details Uses a grid index over the edge servers so each device only measures the
+     * distance to servers in nearby cells. If a device is within the coverage radius
+     * of an edge server, it is marked as `covered` and that server is added to its
+     * list of potential servers (in ascending server index). Cloud servers are added as potential
+     * servers for all covered devices, after their edge servers; only their server
+     * indices are stored, their routing and times being derived from the device's
+     * `CandidateTable::CloudRoute` (see `timeCalculation`). The cost of non-coverage is calculated for
      * devices that remain out of range.
+     * Devices are processed in parallel; the candidate table, the covered list and the
+     * non-coverage cost are then reduced serially in device order, so the output does
+     * not depend on threading.
      *
      * @param[in,out] devices The vector of devices, to be updated with coverage status.
      * @param[in] servers The vector of all servers.
      * @param[in] coverageRadius The maximum distance (km) for a device to be covered.
      * @param[in,out] metrics The metrics object, updated with the cost of non-coverage.
+     * @param[out] candidates The candidate table to fill with every device's potential servers.
      * @return A vector of indices for all covered devices.
      */
-    inline iVec findCovering(Devices& devices, Servers& servers, double coverageRadius, Metrics& metrics) {
-        iVec coveredDeviceIds;
-        for (size_t i = 1; i < devices.size(); ++i) {
+    inline iVec findCovering(Devices& devices, Servers& servers, double coverageRadius, Metrics& metrics, CandidateTable& candidates) {
+        SpatialIndex::EdgeServerGrid grid(servers, coverageRadius);
+        std::vector<std::vector<server_covering>> perDevice(devices.size());
+
+        iVec cloudServers;
+        for (size_t j = 1; j < servers.size(); ++j) {
+            if (servers[j].type == 'C') cloudServers.push_back((int) j);
+        }
+        
+        Parallel::parallelFor(1, devices.size(), [&](size_t i) {
             Device& device = devices[i];
+            std::vector<server_covering>& list = perDevice[i];
             
-            for (size_t j = 1; j < servers.size(); ++j) {
-                const Server& server = servers[j];
-                if (server.type != 'E') continue;
-
-                double distance = calculateDistance(device, server);
-                if (distance <= coverageRadius) {
-                    device.servers.emplace_back((int) j, distance);
-                    device.covered = true;
-                }
-            }
+            grid.query(device.lat, device.lon, list);
+            device.covered = !list.empty();
+        });
+
+        // Serial reduction in device order keeps the result identical to a single-threaded pass.
+        candidates = CandidateTable();
+        size_t edges = 0, covered = 0;
+        for (const auto& list : perDevice) {
+            edges += list.size();
+            covered += !list.empty();
+        }
+        candidates.offsets.reserve(devices.size() + 1);
+        candidates.edgeOffsets.reserve(devices.size() + 1);
+        candidates.routes.reserve(devices.size());
+        candidates.edgeDistances.reserve(edges);
+        candidates.edgeResponseTimes.reserve(edges);
+        candidates.serverIds.reserve(edges + covered * cloudServers.size());
+        candidates.offsets.push_back(0);
+        candidates.edgeOffsets.push_back(0);
+        for (const auto& list : perDevice) candidates.append(list, cloudServers);
+        candidates.cloudProcessing.reserve(cloudServers.size());
+        for (int j : cloudServers) candidates.cloudProcessing.push_back(servers[j].t_p);
 
-            if (device.covered) {
-                coveredDeviceIds.push_back(device.id);
-                for (size_t j = 1; j < servers.size(); ++j) {
-                    const Server& server = servers[j];
-                    if (server.type == 'C') {
-                        device.servers.emplace_back((int) j);
-                    }
-                }
+        iVec coveredDeviceIds;
+        for (size_t i = 1; i < devices.size(); ++i) {
+            if (devices[i].covered) {
+                coveredDeviceIds.push_back(devices[i].id);
             } else {
-                metrics.outputs.cost_of_non_coverage += device.cnd;
+                metrics.outputs.cost_of_non_coverage += devices[i].cnd;
             }
         }
         metrics.outputs.devices_covered_count = coveredDeviceIds.size();
         return coveredDeviceIds;
     }
 
-    constexpr long double SPEED_OF_LIGHT = 299792.458L; // Speed of light in km/s
-    // Latency from Milan to Ohio CC in ms, measured on 2024-12-18.
-    constexpr double INTER_DC_LATENCY_MS = 111.86;
+    constexpr long double SPEED_OF_LIGHT = CandidateTable::SPEED_OF_LIGHT; // Speed of light in km/s
+    constexpr double INTER_DC_LATENCY_MS = CandidateTable::INTER_DC_LATENCY_MS;
 
     /**
-     * @brief Calculates connection, processing, and response times for each potential device-server pair.
-     * @details For each covered device, this function iterates through its list of potential
-     * servers and calculates timing metrics. The connection time for a cloud server
-     * is calculated as a two-hop path (device -> closest edge -> cloud) and includes
-     * a fixed inter-datacenter latency. These values are stored in the `server_covering`
-     * structs within each device.
+     * @brief Calculates the response time of one device's edge slots and its cloud route.
+     * @details The per-device step of `timeCalculation`; also used when a single device
+     * joins a live state (see `Online::Allocator`). The cloud slots need no work here:
+     * `CandidateTable::responseTime` derives them from the route and the edge-to-cloud legs.
      *
-     * @param[in,out] devices The vector of devices to be updated with timing data.
-     * @param[in,out] servers The vector of servers.
+     * @param[in] device The covered device; its `id` is its row in the candidate table.
+     * @param[in] servers The vector of servers.
+     * @param[in,out] candidates The candidate table to be updated with timing data.
      */
-    inline void timeCalculation(Devices& devices, Servers& servers) {
-        for (size_t i = 1; i < devices.size(); ++i) {
-            Device& device = devices[i];
-            if (!device.covered) continue;
-
-            std::pair<int, double> closestEdge = {0, utils::EARTH_RADIUS_KM};
-            for (const auto& s_info : device.servers) {
-                if (servers.at(s_info.id).type == 'E' && s_info.distance < closestEdge.second) {
-                    closestEdge = {s_info.id, s_info.distance};
-                }
+    inline void deviceTimes(const Device& device, const Servers& servers, CandidateTable& candidates) {
+        const int i = device.id;
+        const int begin = candidates.edgeOffsets[i];
+        const int end = candidates.edgeOffsets[i + 1];
+        double transmission_time_ms = (device.s_d / device.bw) * 1000.0;
+
+        CandidateTable::CloudRoute& route = candidates.routes[i];
+        route = CandidateTable::CloudRoute();
+        route.distance = (Real) utils::EARTH_RADIUS_KM;
+        route.transmission = (Real) transmission_time_ms;
+        route.size = device.s_d;
+        for (int e = begin; e < end; ++e) {
+            const int slot = candidates.first(i) + (e - begin);
+            const Server& server = servers.at(candidates.serverIds[slot]);
+            if (candidates.edgeDistances[e] < route.distance) {
+                route.edge = candidates.serverIds[slot];
+                route.distance = candidates.edgeDistances[e];
             }
+            double processingTime = device.s_d * server.t_p;
+            double propagation_delay_ms = (candidates.edgeDistances[e] / SPEED_OF_LIGHT) * 1000.0;
+            double connectionTime = transmission_time_ms + propagation_delay_ms;
+            candidates.edgeResponseTimes[e] = connectionTime + processingTime;
+        }
+    }
 
-            for (auto& s : device.servers) {
-                Server& server = servers.at(s.id);
-                s.processingTime = device.s_d * server.t_p;
-                double transmission_time_ms = (device.s_d / device.bw) * 1000.0;
-                
-                if (server.type == 'C') {
-                    s.id_routing = closestEdge.first;
-                    double propagation_dist = closestEdge.second + calculateDistance(servers.at(closestEdge.first), server);
-                    double propagation_delay_ms = (propagation_dist / SPEED_OF_LIGHT) * 1000.0;
-                    s.connectionTime = transmission_time_ms + propagation_delay_ms + INTER_DC_LATENCY_MS;
-                } else {
-                    double propagation_delay_ms = (s.distance / SPEED_OF_LIGHT) * 1000.0;
-                    s.connectionTime = transmission_time_ms + propagation_delay_ms;
-                }
-                s.responseTime = s.connectionTime + s.processingTime;
-            }
+    /**
+     * @brief Stores the edge-to-cloud legs of every server pair in the candidate table.
+     * @param[in] servers The vector of servers.
+     * @param[in] edgeCloud The edge-to-cloud distances of `servers`.
+     * @param[in,out] candidates The candidate table; its cloud servers are those of its rows.
+     */
+    inline void cloudLegs(const Servers& servers, const SpatialIndex::EdgeCloudDistances& edgeCloud, CandidateTable& candidates) {
+        iVec cloudServers;
+        for (size_t j = 1; j < servers.size(); ++j) {
+            if (servers[j].type == 'C') cloudServers.push_back((int) j);
+        }
+        const size_t stride = cloudServers.size();
+        candidates.cloudLegs.assign(servers.size() * stride, 0.0);
+        for (size_t e = 1; e < servers.size(); ++e) {
+            if (servers[e].type != 'E') continue;
+            for (size_t k = 0; k < stride; ++k) candidates.cloudLegs[e * stride + k] = edgeCloud(servers, (int) e, cloudServers[k]);
         }
     }
 
+    /**
+     * @brief Calculates connection, processing, and response times for each potential device-server pair.
+     * @details For each covered device, this function calculates the response time of its
+     * edge slots and its cloud route with `deviceTimes`. The connection time for a cloud server
+     * is calculated as a two-hop path (device -> closest edge -> cloud) and includes
+     * a fixed inter-datacenter latency; the edge-to-cloud legs are computed once per
+     * server pair (`SpatialIndex::EdgeCloudDistances`) and kept in the candidate table,
+     * so a cloud slot's time is only evaluated when an algorithm reads it. Devices are
+     * independent and are processed in parallel.
+     *
+     * @param[in] devices The vector of devices.
+     * @param[in] servers The vector of servers.
+     * @param[in,out] candidates The candidate table to be updated with timing data.
+     */
+    inline void timeCalculation(const Devices& devices, const Servers& servers, CandidateTable& candidates) {
+        cloudLegs(servers, SpatialIndex::EdgeCloudDistances(servers), candidates);
+        Parallel::parallelFor(1, devices.size(), [&](size_t i) {
+            if (devices[i].covered) deviceTimes(devices[i], servers, candidates);
+        });
+    }
+
     /**
      * @brief Runs the complete coverage and routing time calculation phase.
      * @details This function orchestrates the pre-calculation steps. It retrieves tech
@@ -299,76 +395,106 @@ namespace NetworkResourceAllocation {
      *
      * @param[in,out] devices The main vector of devices.
      * @param[in,out] servers The main vector of servers.
-     * @param[in,out] metrics The metrics object, to be updated during the process.
+     * @param[in,out] metrics The metrics object, to be updated during the process; the
+     * time of `findCovering` and `timeCalculation` is added to its phase times.
+     * @param[out] candidates The candidate table to build.
      * @return A vector of IDs for the devices that were successfully covered.
      */
-    inline iVec coverage(Devices& devices, Servers& servers, Metrics& metrics) {
+    inline iVec coverage(Devices& devices, Servers& servers, Metrics& metrics, CandidateTable& candidates) {
         std::pair<double, double> techProps = techParams(metrics.inputs.tech);
         if (techProps.first < 0) {
             std::cerr << "Error: Invalid technology ID provided." << std::endl;
             return {};
         }
+        if (servers.size() > (size_t) std::numeric_limits<ServerIndex>::max()) {
+            std::cerr << "Error: " << servers.size() - 1 << " servers do not fit the 16-bit server ids of the compact build." << std::endl;
+            return {};
+        }
         bandwidth(devices, servers, techProps.second);
-        iVec coveredDevices = findCovering(devices, servers, techProps.first, metrics);
-        timeCalculation(devices, servers);
+
+        Profiling::ScopedTimer covering("findCovering", &metrics.phases.covering_sec);
+        iVec coveredDevices = findCovering(devices, servers, techProps.first, metrics, candidates);
+        covering.stop();
+
+        Profiling::ScopedTimer timing("timeCalculation", &metrics.phases.timing_sec);
+        timeCalculation(devices, servers, candidates);
+        timing.stop();
         return coveredDevices;
     }
 
     /**
-     * @brief Calculates and populates the metrics object based on a final allocation state.
+     * @brief Allocates a device to one of its potential servers.
+     * @details The single allocation path shared by all algorithms: consumes the
+     * server's capacity in the ledger, records the chosen `server_covering` on the
+     * device and updates the objective tracker. The caller is expected to have
+     * checked `state.ledger.canServe` first.
+     * @param[in,out] state The simulation state to update.
+     * @param[in,out] device The device to be served.
+     * @param[in] candidate The potential server (a slot of `state.candidates`) to allocate it to.
+     * @return The resulting change in cost (non-service + servers used), or 0.0 if the
+     * device was already assigned.
+     */
+    inline double assign(Result& state, Device& device, const server_covering& candidate) {
+        const bool wasOn = state.servers[candidate.id].on;
+        if (!state.ledger.assign(device, state.servers, candidate.id)) return 0.0;
+        device.server = candidate;
+        return state.tracker.assigned(device, state.servers[candidate.id], candidate.responseTime, !wasOn);
+    }
+
+    /**
+     * @brief Removes a device from the server it is allocated to.
+     * @param[in,out] state The simulation state to update.
+     * @param[in,out] device The device to be released.
+     * @return The resulting change in cost (non-service + servers used), or 0.0 if the
+     * device was not served.
+     */
+    inline double release(Result& state, Device& device) {
+        const int serverIdx = state.ledger.assignment[device.id];
+        if (!state.ledger.release(device, state.servers)) return 0.0;
+        const double delta = state.tracker.released(device, state.servers[serverIdx], device.server.responseTime, !state.servers[serverIdx].on);
+        device.server = server_covering();
+        return delta;
+    }
+
+    /**
+     * @brief Populates the metrics object based on a final allocation state.
      * @details This function should be called *after* an allocation algorithm has run. It
-     * resets all output metric counters and then iterates through the final state of
-     * all devices and servers to calculate aggregate statistics like counts of served
-     * devices, used servers, total costs, and average response time.
+     * copies the aggregate statistics (counts of served devices, used servers, total
+     * costs and average response time) from the state's incrementally maintained
+     * `ObjectiveTracker`. Unless `NDEBUG` is defined, the tracker is cross-checked
+     * against a full scan of all devices and servers.
      *
-     * @param[in] devices The state of all devices after an allocation attempt.
-     * @param[in] servers The state of all servers after an allocation attempt.
-     * @param[in,out] metrics The metrics object to be reset and populated.
+     * @param[in] state The simulation state after an allocation attempt.
+     * @param[in,out] metrics The metrics object to be populated.
      */
-    inline void calculateMetrics(const Devices& devices, const Servers& servers, Metrics& metrics) {
-        metrics.outputs.devices_served_count = 0;
-        metrics.outputs.devices_served_ec_count = 0;
-        metrics.outputs.devices_served_cc_count = 0;
-        metrics.outputs.servers_used_count = 0;
-        metrics.outputs.servers_used_ec_count = 0;
-        metrics.outputs.servers_used_cc_count = 0;
-        metrics.outputs.cost_of_servers_used = 0.0;
-        metrics.outputs.cost_of_non_service = 0.0;
-        metrics.outputs.total_cost = 0.0;
-        metrics.outputs.average_response_time = 0.0;        
-        
-        for (const auto& device : devices) {
-            if (device.id == 0) continue;
-            if (device.served) {
-                metrics.outputs.devices_served_count++;
-                metrics.outputs.average_response_time += device.server.responseTime;
-                if (servers.at(device.server.id).type == 'E') {
-                    metrics.outputs.devices_served_ec_count++;
-                } else {
-                    metrics.outputs.devices_served_cc_count++;
-                }
-            } else if (device.covered) {
-                metrics.outputs.cost_of_non_service += device.cnd;
-            }
+    inline void calculateMetrics(const Result& state, Metrics& metrics) {
+        const ObjectiveTracker& tracker = state.tracker;
+
+#ifndef NDEBUG
+        ObjectiveTracker scan;
+        scan.rebuild(state.devices, state.servers, state.coveredDevicesIdx);
+        auto close = [](double a, double b) { return std::abs(a - b) <= 1e-6 * std::max(1.0, std::abs(b)); };
+        if (scan.devices_served_ec != tracker.devices_served_ec || scan.devices_served_cc != tracker.devices_served_cc ||
+            scan.servers_on_ec != tracker.servers_on_ec || scan.servers_on_cc != tracker.servers_on_cc ||
+            !close(scan.cost_of_non_service, tracker.cost_of_non_service) ||
+            !close(scan.cost_of_servers_used, tracker.cost_of_servers_used) ||
+            !close(scan.response_time_sum, tracker.response_time_sum)) {
+            std::cerr << "Warning: incremental objective is out of sync with the allocation state." << std::endl;
         }
-
-        for (const auto& server : servers) {
-            if (server.id == 0) continue;
-            if (server.on) {
-                metrics.outputs.cost_of_servers_used += server.csc;
-                if (server.type == 'E') {
-                    metrics.outputs.servers_used_ec_count++;
-                } else { // 'C'
-                    metrics.outputs.servers_used_cc_count++;
-                }
-            }
-        }
-
+#endif
+
+        metrics.outputs.devices_served_ec_count = tracker.devices_served_ec;
+        metrics.outputs.devices_served_cc_count = tracker.devices_served_cc;
+        metrics.outputs.devices_served_count = tracker.devices_served_ec + tracker.devices_served_cc;
+        metrics.outputs.servers_used_ec_count = tracker.servers_on_ec;
+        metrics.outputs.servers_used_cc_count = tracker.servers_on_cc;
+        metrics.outputs.servers_used_count = tracker.servers_on_ec + tracker.servers_on_cc;
+        metrics.outputs.cost_of_servers_used = tracker.cost_of_servers_used;
+        metrics.outputs.cost_of_non_service = tracker.cost_of_non_service;
+        metrics.outputs.average_response_time = 0.0;
         if (metrics.outputs.devices_served_count > 0) {
-            metrics.outputs.average_response_time /= metrics.outputs.devices_served_count;
+            metrics.outputs.average_response_time = tracker.response_time_sum / metrics.outputs.devices_served_count;
         }
-
-        metrics.outputs.servers_used_count = metrics.outputs.servers_used_ec_count + metrics.outputs.servers_used_cc_count;
         metrics.outputs.total_cost = metrics.outputs.cost_of_non_coverage + metrics.outputs.cost_of_non_service +  metrics.outputs.cost_of_servers_used;
     }
 
@@ -378,6 +504,11 @@ namespace NetworkResourceAllocation {
      * creates the base metrics object, performs the full coverage and time calculation,
      * and bundles all resulting data into a `Result` struct, which is ready to be
      * passed to an allocation algorithm.
+     * When a valid binary snapshot of the scenario exists (see `Snapshot::load`), it is
+     * memory-mapped instead and the data files, coverage and timing steps are skipped.
+     * Otherwise the scenario is computed and its snapshot written for the next run.
+     * The time of each phase (loading, coverage, timing and the whole call) is recorded
+     * in the metrics' `phases`.
      *
      * @param[in] simulation_type The category of the simulation (e.g., "Heuristic").
      * @param[in] algorithm_name The specific name of the algorithm (e.g., "Random").
@@ -385,27 +516,60 @@ namespace NetworkResourceAllocation {
      * @param[in] numServersEC The number of edge servers to load.
      * @param[in] numServersCC The number of cloud servers to load.
      * @param[in] tech The network technology ID.
+     * @param[in,out] rng The random number context; its seed and stream are recorded in the metrics.
+     * @param[in] useSnapshot If false, the scenario is always recomputed and no snapshot is read or written.
      * @return An `std::optional<Result>` containing the initial state, or `std::nullopt` on failure.
      */
-    inline std::optional<Result> pre_calculation(const std::string& simulation_type, const std::string& algorithm_name, int numDevices, int numServersEC, int numServersCC, int tech) {
+    inline std::optional<Result> pre_calculation(const std::string& simulation_type, const std::string& algorithm_name, int numDevices, int numServersEC, int numServersCC, int tech, utils::Rng& rng,
+                                                 bool useSnapshot = true) {
         if (numDevices <= 0 || numServersEC <= 0 || numServersCC <= 0) {
             std::cerr << "Error: Number of devices and servers must be positive." << std::endl;
             return std::nullopt;
         }
         
-        Devices devices = loadDevices(numDevices);
-        Servers servers = loadServers(numServersEC, numServersCC);
+        auto metrics = std::make_unique<Metrics>(simulation_type, algorithm_name, numDevices, numServersEC, numServersCC, tech);
+        metrics->inputs.seed = rng.seed();
+        metrics->inputs.stream = rng.stream();
+        const std::string key = metrics->getBaseFileName();
+        // The metrics object keeps its address when it is moved into the state below.
+        Metrics::PhaseTimes& phases = metrics->phases;
+        Profiling::ScopedTimer total("pre_calculation", &phases.pre_calculation_sec);
+
+        if (useSnapshot) {
+            Profiling::ScopedTimer load("Snapshot::load", &phases.load_sec);
+            auto scenario = Snapshot::load(key, numDevices, numServersEC, numServersCC, tech);
+            load.stop();
+            if (scenario) {
+                metrics->outputs.cost_of_non_coverage = scenario->costOfNonCoverage;
+                metrics->outputs.devices_covered_count = scenario->coveredDevicesIdx.size();
+                Result state{std::move(scenario->devices), std::move(scenario->servers), std::move(scenario->coveredDevicesIdx), std::move(scenario->candidates), std::move(metrics)};
+                state.metrics->memory = state.footprint();
+                total.stop();
+                return state;
+            }
+        }
+
+        Profiling::ScopedTimer load("loadData", &phases.load_sec);
+        Devices devices = loadDevices(numDevices, rng);
+        Servers servers = loadServers(numServersEC, numServersCC, rng);
+        load.stop();
 
         if (devices.empty() || servers.empty()) {
             std::cerr << "Error: Failed to load device or server data." << std::endl;
             return std::nullopt;
         }
 
-        auto metrics = std::make_unique<Metrics>(simulation_type, algorithm_name, numDevices, numServersEC, numServersCC, tech);
-
-        iVec coveredDevicesIdx = coverage(devices, servers, *metrics);
+        auto candidates = std::make_shared<CandidateTable>();
+        iVec coveredDevicesIdx = coverage(devices, servers, *metrics, *candidates);
         
-        return Result{std::move(devices), std::move(servers), std::move(coveredDevicesIdx), std::move(metrics)};
+        Result state{std::move(devices), std::move(servers), std::move(coveredDevicesIdx), std::move(candidates), std::move(metrics)};
+        state.metrics->memory = state.footprint();
+        if (useSnapshot) {
+            Profiling::ScopedTimer save("Snapshot::save");
+            Snapshot::save(state, state.metrics->outputs.cost_of_non_coverage, key);
+        }
+        total.stop();
+        return state;
     }
 
     /**
@@ -422,13 +586,14 @@ namespace NetworkResourceAllocation {
      * @param[in,out] state An std::optional<Result> containing the entire simulation
      * state. The function will directly modify the Device objects within the state's
      * `devices` vector.
+     * @param[in,out] rng The random number context used for a randomized selection.
      * @param[in] randomBottleneck If true, the devices to be modified are selected
      * randomly from the covered devices pool. If false, the selection is deterministic,
      * picking the first devices from the list. Defaults to false.
      * @note This function should be called after the `pre_calculation` step, as it
      * depends on the list of `coveredDevicesIdx`.
      */
-    inline void createBottleneck(std::optional<Result>& state, bool randomBottleneck = false) {
+    inline void createBottleneck(std::optional<Result>& state, utils::Rng& rng, bool randomBottleneck = false) {
         Devices& devices = state->devices;
         Servers& servers = state->servers;
         
@@ -440,15 +605,17 @@ namespace NetworkResourceAllocation {
         
         int loop = state->metrics->inputs.servers_cc;
         iVec idx = state->coveredDevicesIdx;
-        if (randomBottleneck) shuffle(idx.begin(), idx.end(), utils::getEngine());
+        if (randomBottleneck) utils::shuffle(rng, idx.begin(), idx.end());
         int i = 0;
         while (loop--) {
-            //showStructs::showDevice(devices[idx[i]]);
+            //showStructs::showDevice(devices[idx[i]], *state->candidates);
             devices[idx[i]].mem = bottleneckValues[i].first  * 0.999999;
             devices[idx[i]].sto = bottleneckValues[i].second * 0.999999;
             devices[idx[i]].cnd = 9.9;
-            //showStructs::showDevice(devices[idx[i]]);
+            //showStructs::showDevice(devices[idx[i]], *state->candidates);
             i++;
         }
+        state->tracker.rebuild(devices, servers, state->coveredDevicesIdx);
+        state->metrics->inputs.bottlenecks = true;
     }
 }
\ No newline at end of file
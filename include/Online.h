@@ -0,0 +1,524 @@
+#pragma once
+
+#include "Heuristics.h"
+#include "MetaHeuristics.h"
+#include "NetworkResourceAllocation.h"
+#include "SpatialIndex.h"
+
+namespace Online {
+
+    /**
+     * @enum Placement
+     * @brief How an arriving device picks its server.
+     */
+    enum class Placement {
+        Greedy, ///< The feasible candidate with the lowest response time.
+        Regret  ///< The feasible candidate with the lowest increase in cost (switching a server on costs its CSC); batches are placed by decreasing regret.
+    };
+
+    /**
+     * @struct Options
+     * @brief Tuning of the online allocator.
+     */
+    struct Options {
+        Placement placement = Placement::Greedy;
+        int repairInterval = 25;                          ///< Events between local repair passes (0 disables them).
+        int repairLevels = 30;                            ///< Temperature levels of a repair pass.
+        double repairTemperature = 5.0;                   ///< Initial temperature of a repair pass.
+        double repairAlpha = 0.9;                         ///< Cooling rate of a repair pass.
+        int resolveInterval = 250;                        ///< Events between full re-solves (0 disables them).
+        double maxDrift = 0.02;                           ///< Relative cost excess over the re-solve above which its solution is adopted.
+        std::string resolveHeuristic = "Greedy_DescAsc";  ///< Initial solution of a full re-solve, improved by SA.
+        double resolveTemperature = 100.0;                ///< Initial temperature of the re-solve SA.
+        double resolveAlpha = 0.95;                       ///< Cooling rate of the re-solve SA.
+    };
+
+    /**
+     * @struct Stats
+     * @brief What the allocator has done so far.
+     */
+    struct Stats {
+        uint64_t arrivals = 0;
+        uint64_t departures = 0;
+        uint64_t repairs = 0;
+        uint64_t resolves = 0;
+        uint64_t adopted = 0;   ///< Re-solves whose solution replaced the live one.
+        double event_sec = 0.0;  ///< Time spent handling arrivals and departures.
+        double repair_sec = 0.0; ///< Time spent in local repair passes.
+        double resolve_sec = 0.0; ///< Time spent in full re-solves.
+        double lastDrift = 0.0; ///< Relative excess of the live total cost over the last re-solve.
+        double maxDrift = 0.0;  ///< Largest `lastDrift` seen.
+
+        inline double totalSeconds() const { return event_sec + repair_sec + resolve_sec; }
+    };
+
+    /**
+     * @class Allocator
+     * @brief Event-driven allocator that keeps a live `Result` as devices come and go.
+     * @details Built once from a pre-calculated state (with or without an allocation), the
+     * allocator keeps the edge server grid and the edge-to-cloud distances of the
+     * scenario, so an arrival only computes the coverage and response times of the new
+     * device, appends them to the candidate table and places the device against the
+     * current residual capacities. A departure releases the device's capacity. Departed
+     * devices keep their row (and their candidate slots) but leave the covered list, so
+     * the indices of the others never change.
+     *
+     * Every `repairInterval` events a short Simulated Annealing pass re-optimises the
+     * devices that can use a server touched since the last pass. Every
+     * `resolveInterval` events the allocation is solved again from scratch
+     * (`resolveHeuristic` followed by SA); the relative excess of the live cost over it
+     * is recorded as the drift, and when it exceeds `maxDrift` the re-solved allocation
+     * replaces the live one, which bounds the drift at every check.
+     *
+     * The candidate table of the live state is owned by the allocator (copied from the
+     * pre-calculation on construction), so the instance it was built from is untouched.
+     * Repairs run synchronously between events; the allocator is not thread-safe.
+     */
+    class Allocator {
+    public:
+        /**
+         * @brief Creates an allocator over a pre-calculated state.
+         * @param[in] initial The state to take over; it may already hold an allocation.
+         * @param[in] options The placement rule and repair settings.
+         * @param[in] rng The random number context; repair pass `k` draws from stream `2k - 1` and re-solve `k` from stream `2k`.
+         * @return The allocator, or `std::nullopt` if the state has no metrics or an unknown technology (an error is logged).
+         */
+        static inline std::optional<Allocator> create(const Result& initial, Options options, const utils::Rng& rng) {
+            if (!initial.metrics || !initial.candidates) {
+                std::cerr << "Error: Metrics not available." << std::endl;
+                return std::nullopt;
+            }
+            const std::pair<double, double> techProps = NetworkResourceAllocation::techParams(initial.metrics->inputs.tech);
+            if (techProps.first < 0) return std::nullopt;
+            return Allocator(initial, std::move(options), rng, techProps.first, techProps.second);
+        }
+
+        /**
+         * @brief The live state.
+         */
+        inline const Result& state() const { return live; }
+        inline const Stats& stats() const { return counters; }
+
+        /**
+         * @brief Restarts the statistics, e.g., once the initial population is in place.
+         */
+        inline void clearStats() { counters = Stats(); }
+
+        /**
+         * @brief Whether a device index refers to a device currently in the instance.
+         */
+        inline bool present(int d) const { return d > 0 && d < (int) presence.size() && presence[d]; }
+
+        /**
+         * @brief Adds a device and places it with the configured rule.
+         * @param[in] device The new device's static attributes; its id, bandwidth and
+         * state are assigned here.
+         * @return The index of the device in the live state.
+         */
+        inline int arrive(Device device) {
+            const int d = add(std::move(device));
+            {
+                Profiling::ScopedTimer timer("Online::arrive", &counters.event_sec, "online");
+                if (live.devices[d].covered) place(d);
+            }
+            afterEvent();
+            return d;
+        }
+
+        /**
+         * @brief Adds several devices at once and places them.
+         * @details With `Placement::Greedy` the devices are placed by decreasing cost of
+         * non-service; with `Placement::Regret` the device whose best option is most
+         * ahead of its second best is placed first. The regrets are refreshed as in
+         * `Heuristics::priorityFill`: the device on top is re-evaluated before it is placed,
+         * and filling an edge server re-evaluates the waiting devices that have it among
+         * their candidates.
+         * @param[in] devices The new devices.
+         * @return The indices of the devices in the live state, in input order.
+         */
+        inline iVec arrive(const Devices& devices) {
+            iVec added;
+            for (const Device& device : devices) added.push_back(add(device));
+            {
+                Profiling::ScopedTimer timer("Online::arriveBatch", &counters.event_sec, "online");
+                placeBatch(added);
+            }
+            for (size_t k = 0; k < added.size(); ++k) afterEvent();
+            return added;
+        }
+
+        /**
+         * @brief Places every covered device that is not served yet, as one batch.
+         * @details Used to start from a pre-calculated state without an allocation. The
+         * order follows the placement rule, as in `arrive(const Devices&)`. It is not counted as an event.
+         */
+        inline void placeUnserved() {
+            Profiling::ScopedTimer timer("Online::placeUnserved", &counters.event_sec, "online");
+            iVec waiting;
+            for (int d : live.coveredDevicesIdx) {
+                if (!live.devices[d].served) waiting.push_back(d);
+            }
+            placeBatch(waiting);
+        }
+
+        /**
+         * @brief Removes a device from the instance and frees its capacity.
+         * @param[in] d The index of the device in the live state.
+         * @return `true` if the device was present, `false` otherwise (an error is logged).
+         */
+        inline bool depart(int d) {
+            {
+                Profiling::ScopedTimer timer("Online::depart", &counters.event_sec, "online");
+                if (!withdraw(d)) return false;
+                ++counters.departures;
+            }
+            afterEvent();
+            return true;
+        }
+
+        /**
+         * @brief Removes a device like `depart`, without counting an event.
+         * @details Used to shape the initial population; no repair or re-solve is triggered.
+         * @param[in] d The index of the device in the live state.
+         * @return `true` if the device was present, `false` otherwise (an error is logged).
+         */
+        inline bool withdraw(int d) {
+            if (!present(d)) {
+                std::cerr << "Error: Device " << d << " is not in the instance." << std::endl;
+                return false;
+            }
+            Device& device = live.devices[d];
+            Metrics& metrics = *live.metrics;
+            if (device.covered) {
+                const int serverIdx = live.ledger.assignment[d];
+                if (serverIdx != 0) touch(serverIdx);
+                NetworkResourceAllocation::release(live, device);
+                live.tracker.removed(device);
+                iVec& covered = live.coveredDevicesIdx;
+                covered.erase(std::lower_bound(covered.begin(), covered.end(), d));
+                metrics.outputs.devices_covered_count--;
+                device.covered = false;
+            } else {
+                metrics.outputs.cost_of_non_coverage -= device.cnd;
+            }
+            presence[d] = 0;
+            return true;
+        }
+
+        /**
+         * @brief Re-optimises the devices around the servers touched since the last pass.
+         * @details Runs a short SA chain whose neighbors only relocate the covered devices
+         * that have a touched server among their candidates (which includes the devices
+         * that arrived on them or could take a freed slot). The best allocation found is
+         * kept, so a pass never increases the cost.
+         */
+        inline void repair() {
+            if (touchedList.empty()) return;
+            Profiling::ScopedTimer timer("Online::repair", &counters.repair_sec, "online");
+            const CandidateTable& candidates = *table;
+            iVec pool;
+            for (int d : live.coveredDevicesIdx) {
+                for (int slot = candidates.first(d); slot < candidates.last(d); ++slot) {
+                    if (touched[candidates.serverIds[slot]]) {
+                        pool.push_back(d);
+                        break;
+                    }
+                }
+            }
+            for (int j : touchedList) touched[j] = 0;
+            touchedList.clear();
+            if (pool.empty()) return;
+
+            MetaHeuristics::AnnealingChain chain(live, rng.split(2 * ++repairStreams - 1), options.repairTemperature, options.repairAlpha, &pool);
+            chain.run(options.repairLevels);
+            chain.finish();
+            ++counters.repairs;
+        }
+
+        /**
+         * @brief Solves the current instance from scratch and bounds the drift of the live allocation.
+         * @details The re-solve starts from an empty allocation of a copy of the live state.
+         * If the live total cost exceeds the re-solved one by more than `maxDrift` (relative),
+         * the re-solved allocation replaces the live one.
+         * @return The relative excess of the live cost over the re-solve, before any replacement.
+         */
+        inline double resolve() {
+            Profiling::ScopedTimer timer("Online::resolve", &counters.resolve_sec, "online");
+            Result fresh = live;
+            for (int d : fresh.coveredDevicesIdx) NetworkResourceAllocation::release(fresh, fresh.devices[d]);
+
+            utils::Rng resolveRng = rng.split(2 * ++resolveStreams);
+            if (!Heuristics::run(options.resolveHeuristic, fresh, resolveRng)) return 0.0;
+            MetaHeuristics::run("SA", fresh, options.resolveTemperature, options.resolveAlpha, resolveRng);
+
+            // Total costs: the non-coverage part is the same for both allocations.
+            const double nonCoverage = live.metrics->outputs.cost_of_non_coverage;
+            const double current = nonCoverage + live.tracker.allocationCost();
+            const double reference = nonCoverage + fresh.tracker.allocationCost();
+            const double drift = reference > 0.0 ? (current - reference) / reference : 0.0;
+            counters.lastDrift = drift;
+            counters.maxDrift = std::max(counters.maxDrift, drift);
+            ++counters.resolves;
+
+            if (drift > options.maxDrift) {
+                MetaHeuristics::restoreAssignment(live, fresh.ledger.assignment);
+                ++counters.adopted;
+            }
+            return drift;
+        }
+
+        /**
+         * @brief Brings the metrics of the live state up to date.
+         * @details Execution time is the time spent on events, repairs and re-solves.
+         */
+        inline void updateMetrics() {
+            NetworkResourceAllocation::calculateMetrics(live, *live.metrics);
+            live.metrics->outputs.execution_time_sec = counters.totalSeconds();
+        }
+
+    private:
+        Result live;
+        std::shared_ptr<CandidateTable> table; ///< The live candidate table, shared (read-only) with `live`.
+        Options options;
+        utils::Rng rng;
+        uint64_t repairStreams = 0;  ///< Repair passes drawn so far; they take the odd streams.
+        uint64_t resolveStreams = 0; ///< Re-solves drawn so far; they take the even streams above 0.
+        double dataRate;
+        SpatialIndex::EdgeServerGrid grid;
+        iVec cloudServers;
+        std::vector<char> presence;  ///< Per device: still in the instance.
+        std::vector<char> touched;   ///< Per server: capacity changed since the last repair.
+        iVec touchedList;
+        uint64_t events = 0;
+        std::vector<server_covering> scratch;
+        Stats counters;
+
+        Allocator(const Result& initial, Options options_, const utils::Rng& rng_, double coverageRadius, double dataRate_)
+            : live(initial), table(std::make_shared<CandidateTable>(*initial.candidates)), options(std::move(options_)), rng(rng_),
+              dataRate(dataRate_), grid(initial.servers, coverageRadius),
+              presence(initial.devices.size(), 1), touched(initial.servers.size(), 0) {
+            live.candidates = table;
+            presence[0] = 0;
+            for (size_t j = 1; j < live.servers.size(); ++j) {
+                if (live.servers[j].type == 'C') cloudServers.push_back((int) j);
+            }
+        }
+
+        inline void touch(int serverIdx) {
+            if (touched[serverIdx]) return;
+            touched[serverIdx] = 1;
+            touchedList.push_back(serverIdx);
+        }
+
+        /**
+         * @brief Appends a device to the live state with its coverage and response times.
+         * @return The index of the new device. It is covered (and in the covered list) but unserved.
+         */
+        inline int add(Device device) {
+            Profiling::ScopedTimer timer("Online::add", &counters.event_sec, "online");
+            const int d = (int) live.devices.size();
+            device.id = d;
+            device.bw = dataRate;
+            device.served = false;
+            device.server = server_covering();
+
+            scratch.clear();
+            grid.query(device.lat, device.lon, scratch);
+            device.covered = !scratch.empty();
+
+            CandidateTable& candidates = *table;
+            candidates.append(scratch, cloudServers);
+
+            live.devices.push_back(device);
+            live.ledger.assignment.push_back(0);
+            presence.push_back(1);
+            ++counters.arrivals;
+
+            Metrics& metrics = *live.metrics;
+            if (device.covered) {
+                NetworkResourceAllocation::deviceTimes(live.devices[d], live.servers, candidates);
+                live.coveredDevicesIdx.push_back(d);
+                live.tracker.added(live.devices[d]);
+                metrics.outputs.devices_covered_count++;
+            } else {
+                metrics.outputs.cost_of_non_coverage += device.cnd;
+            }
+            return d;
+        }
+
+        /**
+         * @brief The increase in cost of serving a device on a candidate slot.
+         */
+        inline double slotCost(int slot) const {
+            const Server& server = live.servers[table->serverIds[slot]];
+            return server.on ? 0.0 : server.csc;
+        }
+
+        /**
+         * @brief The best feasible candidate slot of a device under the placement rule, or -1.
+         */
+        inline int bestSlot(int d) const {
+            const CandidateTable& candidates = *table;
+            const Device& device = live.devices[d];
+            int best = -1;
+            for (int slot = candidates.first(d); slot < candidates.last(d); ++slot) {
+                if (!live.ledger.canServe(candidates.serverIds[slot], device)) continue;
+                if (best < 0) { best = slot; continue; }
+                if (options.placement == Placement::Regret) {
+                    const double cost = slotCost(slot), bestCost = slotCost(best);
+                    if (cost < bestCost || (cost == bestCost && candidates.responseTime(d, slot) < candidates.responseTime(d, best))) best = slot;
+                } else if (candidates.responseTime(d, slot) < candidates.responseTime(d, best)) {
+                    best = slot;
+                }
+            }
+            return best;
+        }
+
+        /**
+         * @brief How much worse a device's second-best option is than its best one.
+         * @details Leaving the device unserved (costing its CND) counts as an option, so a
+         * device with a single feasible server has a large regret.
+         */
+        inline double regret(int d) const {
+            const CandidateTable& candidates = *table;
+            const Device& device = live.devices[d];
+            double first = device.cnd, second = device.cnd;
+            for (int slot = candidates.first(d); slot < candidates.last(d); ++slot) {
+                if (!live.ledger.canServe(candidates.serverIds[slot], device)) continue;
+                const double cost = slotCost(slot);
+                if (cost < first) { second = first; first = cost; }
+                else if (cost < second) second = cost;
+            }
+            return second - first;
+        }
+
+        inline void placeBatch(iVec waiting) {
+            waiting.erase(std::remove_if(waiting.begin(), waiting.end(), [this](int d) { return !live.devices[d].covered || live.devices[d].served; }), waiting.end());
+            if (options.placement == Placement::Greedy) {
+                std::stable_sort(waiting.begin(), waiting.end(), [this](int a, int b) { return live.devices[a].cnd > live.devices[b].cnd; });
+                for (int d : waiting) place(d);
+                return;
+            }
+            // The queue holds positions in `waiting`, so equal regrets go in batch order.
+            const CandidateTable& candidates = *table;
+            std::vector<iVec> byEdge(live.servers.size());
+            utils::IndexedPriorityQueue<double> queue(waiting.size());
+            for (int k = 0; k < (int) waiting.size(); ++k) {
+                const int d = waiting[k];
+                for (int slot = candidates.first(d); slot < candidates.last(d); ++slot) {
+                    if (live.servers[candidates.serverIds[slot]].type == 'E') byEdge[candidates.serverIds[slot]].push_back(k);
+                }
+                queue.update(k, regret(d));
+            }
+
+            while (!queue.empty()) {
+                const int k = queue.top();
+                const double r = regret(waiting[k]);
+                if (r != queue.key(k)) {
+                    queue.update(k, r);
+                    continue;
+                }
+                queue.erase(k);
+                if (!place(waiting[k])) continue;
+                const int j = live.ledger.assignment[waiting[k]];
+                if (live.servers[j].type != 'E') continue;
+                for (int other : byEdge[j]) {
+                    if (queue.contains(other)) queue.update(other, regret(waiting[other]));
+                }
+            }
+        }
+
+        inline bool place(int d) {
+            const int slot = bestSlot(d);
+            if (slot < 0) return false;
+            NetworkResourceAllocation::assign(live, live.devices[d], table->entry(d, slot));
+            touch(table->serverIds[slot]);
+            return true;
+        }
+
+        inline void afterEvent() {
+            ++events;
+            if (options.repairInterval > 0 && events % options.repairInterval == 0) repair();
+            if (options.resolveInterval > 0 && events % options.resolveInterval == 0) resolve();
+        }
+    };
+
+    /**
+     * @brief Runs an online scenario on a pre-calculated instance and reports its metrics.
+     * @details The devices of the instance form the population: about half of them are in
+     * the instance at the start, placed as one batch and re-solved, and each event is either the
+     * arrival of an absent device (with probability absent / D) or the departure of a
+     * present one. An arriving device is added as a new device with the attributes of
+     * the one it stands for, so its coverage and response times are computed again.
+     * The final allocation is reported with simulation type "Online"; percentages are
+     * relative to the instance size D, and the statistics and execution time only cover
+     * the events.
+     *
+     * @param[in] algorithm The placement rule: "Greedy" or "Regret".
+     * @param[in] state The initial state from the pre-calculation phase (not modified).
+     * @param[in] events The number of arrivals and departures to simulate.
+     * @param[in] rng The random number context; the events draw from stream 0, the repairs from the odd streams and the re-solves from the other even ones.
+     * @param[in] options The repair settings; `placement` is set from `algorithm`.
+     */
+    inline void bootup(const std::string& algorithm, const Result& state, int events, const utils::Rng& rng, Options options = {}) {
+        if (algorithm == "Greedy") {
+            options.placement = Placement::Greedy;
+        } else if (algorithm == "Regret") {
+            options.placement = Placement::Regret;
+        } else {
+            std::cerr << "Error: Unknown online placement rule '" << algorithm << "'." << std::endl;
+            return;
+        }
+
+        auto allocator = Allocator::create(state, options, rng);
+        if (!allocator) return;
+        utils::Rng eventRng = rng.split(0);
+
+        // Live index of every base device, or 0 while it is absent. About half of them start absent.
+        const int D = (int) state.devices.size() - 1;
+        iVec live(D + 1, 0), present, absent;
+        for (int b = 1; b <= D; ++b) {
+            if (utils::randomNumber(eventRng, 0, 1) == 0) {
+                allocator->withdraw(b);
+                absent.push_back(b);
+            } else {
+                live[b] = b;
+                present.push_back(b);
+            }
+        }
+        allocator->placeUnserved();
+        allocator->resolve();
+        allocator->clearStats();
+
+        for (int e = 0; e < events && D > 0; ++e) {
+            const bool arrival = utils::randomNumber(eventRng, 0, D - 1) < (int) absent.size();
+            iVec& from = arrival ? absent : present;
+            iVec& to = arrival ? present : absent;
+            const int k = utils::randomNumber(eventRng, 0, (int) from.size() - 1);
+            const int b = from[k];
+            if (arrival) {
+                live[b] = allocator->arrive(state.devices[b]);
+            } else {
+                allocator->depart(live[b]);
+                live[b] = 0;
+            }
+            from[k] = from.back();
+            from.pop_back();
+            to.push_back(b);
+        }
+        allocator->resolve();
+        allocator->updateMetrics();
+
+        const Stats& stats = allocator->stats();
+        std::cout << "Online " << algorithm << ": " << stats.arrivals << " arrivals, " << stats.departures << " departures, "
+                  << stats.repairs << " repairs, " << stats.resolves << " re-solves (" << stats.adopted << " adopted), max drift "
+                  << utils::toString(100.0 * stats.maxDrift, 2) << "%, "
+                  << utils::toString(1e6 * stats.event_sec / std::max<uint64_t>(stats.arrivals + stats.departures, 1), 2) << " us/event" << std::endl;
+
+        auto metrics = std::make_unique<HeuristicMetrics>("Online", algorithm, allocator->state().metrics);
+        metrics->inputs.seed = rng.seed();
+        metrics->inputs.stream = 0;
+        showStructs::showMetrics(*metrics);
+        metrics->saveResultsToFile();
+    }
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Parallel {
+
+    /**
+     * @brief Returns the number of worker threads to use by default.
+     * @details Uses `std::thread::hardware_concurrency`, falling back to a single
+     * thread when the platform cannot report it.
+     * @return The number of hardware threads (at least 1).
+     */
+    inline unsigned defaultThreads() {
+        unsigned n = std::thread::hardware_concurrency();
+        return n == 0 ? 1 : n;
+    }
+
+    /**
+     * @brief Runs `fn(i)` for every `i` in `[begin, end)` across several threads.
+     * @details The range is split into one contiguous chunk per thread, so each index is
+     * handled by exactly one thread and `fn` must only write state owned by index `i`.
+     * Ranges shorter than `minChunk` per thread run on the calling thread. The first
+     * exception thrown by any chunk is rethrown once all threads have joined.
+     *
+     * @tparam Fn A callable with signature `void(size_t)`.
+     * @param[in] begin The first index (inclusive).
+     * @param[in] end The last index (exclusive).
+     * @param[in] fn The function to apply to each index.
+     * @param[in] threads The maximum number of threads to use.
+     * @param[in] minChunk The minimum number of indices worth handing to a thread.
+     */
+    template <typename Fn>
+    inline void parallelFor(size_t begin, size_t end, Fn&& fn, unsigned threads = defaultThreads(), size_t minChunk = 64) {
+        if (end <= begin) return;
+        const size_t length = end - begin;
+        const size_t workers = std::max<size_t>(1, std::min<size_t>(threads, length / std::max<size_t>(minChunk, 1)));
+
+        if (workers <= 1) {
+            for (size_t i = begin; i < end; ++i) fn(i);
+            return;
+        }
+
+        const size_t chunk = (length + workers - 1) / workers;
+        std::vector<std::thread> pool;
+        std::vector<std::exception_ptr> errors(workers);
+        pool.reserve(workers);
+        for (size_t w = 0; w < workers; ++w) {
+            const size_t first = begin + w * chunk;
+            const size_t last = std::min(end, first + chunk);
+            pool.emplace_back([&, w, first, last]() {
+                try {
+                    for (size_t i = first; i < last; ++i) fn(i);
+                } catch (...) {
+                    errors[w] = std::current_exception();
+                }
+            });
+        }
+        for (auto& t : pool) t.join();
+        for (auto& e : errors) {
+            if (e) std::rethrow_exception(e);
+        }
+    }
+
+    /**
+     * @class WorkStealingPool
+     * @brief A fixed set of worker threads running independent tasks of uneven length.
+     * @details Every worker owns a task deque. A task submitted from inside a worker goes
+     * to the back of that worker's deque, and the worker pops from the back, so follow-up
+     * tasks run close to the data of the task that created them. Tasks submitted from
+     * outside the pool are dealt round-robin. An idle worker steals from the front of the
+     * other deques, so one long task never leaves the remaining ones waiting.
+     * Tasks may submit further tasks. `wait` blocks until every task, including those
+     * submitted while waiting, has finished, and rethrows the first exception a task threw.
+     */
+    class WorkStealingPool {
+    public:
+        /**
+         * @param[in] threads The number of workers (0 uses `defaultThreads()`).
+         */
+        explicit WorkStealingPool(unsigned threads = defaultThreads()) {
+            const unsigned count = threads == 0 ? defaultThreads() : threads;
+            for (unsigned w = 0; w < count; ++w) queues.push_back(std::make_unique<Queue>());
+            for (unsigned w = 0; w < count; ++w) workers.emplace_back([this, w]() { work(w); });
+        }
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+        ~WorkStealingPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto& t : workers) t.join();
+        }
+
+        inline size_t size() const { return workers.size(); }
+
+        /**
+         * @brief Queues a task.
+         * @param[in] task The callable to run on one of the workers.
+         */
+        inline void submit(std::function<void()> task) {
+            const size_t target = (currentPool == this) ? currentWorker : nextQueue++ % queues.size();
+            {
+                // The task is counted in the same critical section that queues it, so a
+                // worker that steals it at once can never uncount it first.
+                std::lock_guard<std::mutex> lock(mutex);
+                std::lock_guard<std::mutex> queueLock(queues[target]->mutex);
+                queues[target]->tasks.push_back(std::move(task));
+                ++queued;
+                ++unfinished;
+            }
+            wake.notify_one();
+        }
+
+        /**
+         * @brief Blocks until every submitted task has finished.
+         * @exception Rethrows the first exception thrown by a task.
+         */
+        inline void wait() {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this]() { return unfinished == 0; });
+            if (error) {
+                std::exception_ptr e = error;
+                error = nullptr;
+                std::rethrow_exception(e);
+            }
+        }
+
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+        std::mutex mutex;                 ///< Guards the counters below.
+        std::condition_variable wake;     ///< Signalled when a task is queued or the pool stops.
+        std::condition_variable done;     ///< Signalled when the last unfinished task ends.
+        size_t queued = 0;                ///< Tasks sitting in a deque.
+        size_t unfinished = 0;            ///< Tasks queued or running.
+        bool stopping = false;
+        std::exception_ptr error;
+        std::atomic<size_t> nextQueue{0};
+
+        static inline thread_local const WorkStealingPool* currentPool = nullptr;
+        static inline thread_local size_t currentWorker = 0;
+
+        inline bool take(size_t self, std::function<void()>& task) {
+            {
+                Queue& own = *queues[self];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (!own.tasks.empty()) {
+                    task = std::move(own.tasks.back());
+                    own.tasks.pop_back();
+                    return true;
+                }
+            }
+            for (size_t k = 1; k < queues.size(); ++k) {
+                Queue& victim = *queues[(self + k) % queues.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.tasks.empty()) {
+                    task = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        inline void work(size_t self) {
+            currentPool = this;
+            currentWorker = self;
+            std::function<void()> task;
+            while (true) {
+                if (take(self, task)) {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        --queued;
+                    }
+                    try {
+                        task();
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (!error) error = std::current_exception();
+                    }
+                    task = nullptr;
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (--unfinished == 0) done.notify_all();
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return queued > 0 || stopping; });
+                if (stopping && queued == 0) return;
+            }
+        }
+    };
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Profiling {
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @class Trace
+     * @brief Collects timed spans and writes them as a Chrome trace JSON file.
+     * @details Tracing is off until `enable` is called; while it is off, `record` returns
+     * right away, so the timers cost two clock reads and nothing else. The file uses the
+     * Trace Event Format ("X" complete events, timestamps in microseconds since the trace
+     * was enabled) and opens in `chrome://tracing` or Perfetto. Threads are numbered in
+     * the order they first record a span. All member functions are thread-safe.
+     */
+    class Trace {
+    public:
+        /**
+         * @brief The trace shared by every timer. Written automatically at program exit.
+         */
+        static inline Trace& global() {
+            static Trace trace;
+            return trace;
+        }
+
+        Trace() = default;
+        Trace(const Trace&) = delete;
+        Trace& operator=(const Trace&) = delete;
+        ~Trace() { write(); }
+
+        /**
+         * @brief Starts collecting spans, to be written to `file`.
+         * @param[in] file The JSON file to write (e.g., "Results/trace.json").
+         */
+        inline void enable(const std::filesystem::path& file) {
+            std::lock_guard<std::mutex> lock(mutex);
+            path = file;
+            origin = Clock::now();
+            events.clear();
+            on.store(true, std::memory_order_release);
+        }
+
+        inline bool enabled() const { return on.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Records a completed span.
+         * @param[in] name The span name; must outlive the trace (a string literal).
+         * @param[in] category The span category; must outlive the trace (a string literal).
+         * @param[in] start When the span started.
+         * @param[in] end When the span ended.
+         * @param[in] args Optional JSON object members shown with the span (e.g., `"accepted":12`).
+         */
+        inline void record(const char* name, const char* category, Clock::time_point start, Clock::time_point end, std::string args = {}) {
+            if (!enabled()) return;
+            std::lock_guard<std::mutex> lock(mutex);
+            auto thread = threads.emplace(std::this_thread::get_id(), (uint32_t) threads.size() + 1).first;
+            events.push_back({name, category,
+                              std::chrono::duration_cast<std::chrono::microseconds>(start - origin).count(),
+                              std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(),
+                              thread->second, std::move(args)});
+        }
+
+        /**
+         * @brief Writes every span recorded so far. Tracing stays enabled.
+         * @return `true` if the file was written or tracing is off, `false` otherwise (an error is logged).
+         */
+        inline bool write() {
+            if (!enabled()) return true;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path());
+            std::ofstream out(path, std::ios::trunc);
+            if (!out.is_open()) {
+                std::cerr << "Error: Could not write trace file " << path.string() << std::endl;
+                return false;
+            }
+            out << "{\"traceEvents\":[";
+            for (size_t e = 0; e < events.size(); ++e) {
+                const Event& event = events[e];
+                out << (e == 0 ? "\n" : ",\n")
+                    << "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category << "\",\"ph\":\"X\""
+                    << ",\"ts\":" << event.ts << ",\"dur\":" << event.dur << ",\"pid\":1,\"tid\":" << event.tid;
+                if (!event.args.empty()) out << ",\"args\":{" << event.args << "}";
+                out << "}";
+            }
+            out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+            return (bool) out;
+        }
+
+    private:
+        struct Event {
+            const char* name;
+            const char* category;
+            int64_t ts;
+            int64_t dur;
+            uint32_t tid;
+            std::string args;
+        };
+
+        std::atomic<bool> on{false};
+        std::mutex mutex;
+        std::filesystem::path path;
+        Clock::time_point origin = Clock::now();
+        std::vector<Event> events;
+        std::unordered_map<std::thread::id, uint32_t> threads;
+    };
+
+    /**
+     * @class ScopedTimer
+     * @brief Measures the wall-clock time of a scope.
+     * @details On `stop` (or destruction) the elapsed seconds are added to `seconds`, when
+     * given, so a phase entered several times accumulates, and the span is recorded in
+     * `Trace::global()` when tracing is enabled.
+     */
+    class ScopedTimer {
+    public:
+        /**
+         * @param[in] name_ The span name in the trace; must be a string literal.
+         * @param[out] seconds_ Where to accumulate the elapsed time, or `nullptr` for a trace-only span.
+         * @param[in] category_ The span category in the trace; must be a string literal.
+         */
+        explicit ScopedTimer(const char* name_, double* seconds_ = nullptr, const char* category_ = "phase")
+            : name(name_), category(category_), seconds(seconds_), start(Clock::now()) {}
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+        ~ScopedTimer() { stop(); }
+
+        /**
+         * @brief Stops the timer. Later calls (and the destructor) do nothing.
+         * @param[in] args Optional JSON object members attached to the trace span.
+         * @return The elapsed time (s).
+         */
+        inline double stop(std::string args = {}) {
+            if (stopped) return elapsed;
+            stopped = true;
+            const Clock::time_point end = Clock::now();
+            elapsed = std::chrono::duration<double>(end - start).count();
+            if (seconds) *seconds += elapsed;
+            Trace::global().record(name, category, start, end, std::move(args));
+            return elapsed;
+        }
+
+    private:
+        const char* name;
+        const char* category;
+        double* seconds;
+        Clock::time_point start;
+        double elapsed = 0.0;
+        bool stopped = false;
+    };
+}
@@ -0,0 +1,292 @@
+#pragma once
+
+#include "utils.h"
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @struct ResultField
+ * @brief One typed cell of a results row.
+ * @details Keeps the value in its native type, so the binary format stores it exactly.
+ * `precision` is the number of decimals used by the text format, which leaves a NaN
+ * real (a value that does not apply to the row) empty.
+ */
+struct ResultField {
+    enum class Type : uint8_t { Int = 0, UInt = 1, Real = 2, Text = 3 };
+
+    Type type = Type::Int;
+    int64_t i = 0;
+    uint64_t u = 0;
+    double r = 0.0;
+    std::string s;
+    int precision = 6;
+
+    static inline ResultField integer(int64_t value) { ResultField f; f.type = Type::Int; f.i = value; return f; }
+    static inline ResultField unsignedInteger(uint64_t value) { ResultField f; f.type = Type::UInt; f.u = value; return f; }
+    static inline ResultField real(double value, int precision = 6) { ResultField f; f.type = Type::Real; f.r = value; f.precision = precision; return f; }
+    static inline ResultField text(std::string value) { ResultField f; f.type = Type::Text; f.s = std::move(value); return f; }
+
+    /**
+     * @brief Formats the value as it appears in the text results files.
+     */
+    inline std::string str() const {
+        switch (type) {
+            case Type::Int:  return utils::toString(i);
+            case Type::UInt: return utils::toString(u);
+            case Type::Real: return std::isnan(r) ? std::string() : utils::toString(r, precision);
+            default:         return s;
+        }
+    }
+};
+
+/**
+ * @class ResultsSink
+ * @brief Buffered, long-lived writer for the per-configuration results files.
+ * @details Every results file is opened once, on its first row, and stays open until
+ * the sink is flushed for good or destroyed. Rows are buffered per file and written
+ * in batches of `batchRows`, so a sweep of thousands of runs does not reopen (or
+ * even touch) the filesystem for each row. Two formats are available:
+ * - `Format::Text`: the historical `;`-delimited `.txt` file with a header line.
+ * - `Format::Binary`: a compact, column-oriented `.bin` file. It starts with the
+ *   schema (`"NRARES1"`, version, column count, then per column its type tag and
+ *   name) followed by record batches. Each batch holds its row count and, per column,
+ *   either `rows` 8-byte values (Int/UInt/Real) or `rows + 1` `uint32` offsets and
+ *   the concatenated bytes (Text). All values are in native byte order.
+ * Rows are only appended to an existing file whose header line (Text) or schema
+ * (Binary) matches the one of the row. Otherwise the old file is renamed aside, to
+ * `<name>.1.txt` (or the next free number), and a new one is started, so a column
+ * change neither misaligns nor discards any rows.
+ * Buffered rows are lost if the process is killed before they are flushed. All
+ * member functions are thread-safe.
+ */
+class ResultsSink {
+public:
+    enum class Format { Text, Binary };
+
+    /**
+     * @brief The sink shared by every `Metrics::saveResultsToFile` call.
+     * @details Flushed automatically at program exit.
+     */
+    static inline ResultsSink& global() {
+        static ResultsSink sink;
+        return sink;
+    }
+
+    ResultsSink() = default;
+    ResultsSink(const ResultsSink&) = delete;
+    ResultsSink& operator=(const ResultsSink&) = delete;
+    ~ResultsSink() { close(); }
+
+    /**
+     * @brief Selects the output format of the files opened from now on.
+     */
+    inline void setFormat(Format f) {
+        std::lock_guard<std::mutex> lock(mutex);
+        format = f;
+    }
+
+    /**
+     * @brief Sets how many rows are buffered per file before they are written.
+     * @param[in] rows The batch size; 1 writes every row immediately.
+     */
+    inline void setBatchRows(size_t rows) {
+        std::lock_guard<std::mutex> lock(mutex);
+        batchRows = std::max<size_t>(rows, 1);
+    }
+
+    /**
+     * @brief Queues a results row.
+     * @param[in] directory The directory of the results file.
+     * @param[in] baseName The file name, without extension.
+     * @param[in] header The column names, written when the file is created.
+     * @param[in] row The typed cells of the row, one per column.
+     */
+    inline void write(const std::filesystem::path& directory, const std::string& baseName, const std::vector<std::string>& header, std::vector<ResultField> row) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const std::filesystem::path path = directory / (baseName + (format == Format::Text ? ".txt" : ".bin"));
+        auto it = files.find(path.string());
+        if (it == files.end()) {
+            it = files.emplace(path.string(), File()).first;
+            open(it->second, path, header, row);
+        }
+        File& file = it->second;
+        if (!file.ok) return;
+        file.pending.push_back(std::move(row));
+        if (file.pending.size() >= batchRows) writePending(file);
+    }
+
+    /**
+     * @brief Writes every buffered row to its file, keeping the files open.
+     */
+    inline void flush() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& entry : files) {
+            writePending(entry.second);
+            if (entry.second.ok) entry.second.out.flush();
+        }
+    }
+
+    /**
+     * @brief Writes every buffered row and closes all files.
+     */
+    inline void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& entry : files) writePending(entry.second);
+        files.clear();
+    }
+
+private:
+    struct File {
+        std::ofstream out;
+        Format format = Format::Text;
+        bool ok = false;
+        bool empty = true;                          ///< Text format: no row written yet, so no separator is needed.
+        std::vector<ResultField::Type> types;       ///< Binary format: column types fixed by the first row.
+        std::vector<std::vector<ResultField>> pending;
+    };
+
+    std::mutex mutex;
+    Format format = Format::Text;
+    size_t batchRows = 32;
+    std::unordered_map<std::string, File> files;
+
+    static inline std::string schema(const std::vector<std::string>& header, const std::vector<ResultField>& row) {
+        std::string blob("NRARES1", 8);
+        auto put = [&blob](const void* data, size_t bytes) { blob.append(static_cast<const char*>(data), bytes); };
+        const uint32_t version = 1, columns = (uint32_t) row.size();
+        put(&version, sizeof(version));
+        put(&columns, sizeof(columns));
+        for (size_t c = 0; c < row.size(); ++c) {
+            const uint8_t type = static_cast<uint8_t>(row[c].type);
+            const std::string& name = c < header.size() ? header[c] : std::string();
+            const uint16_t length = (uint16_t) name.size();
+            put(&type, sizeof(type));
+            put(&length, sizeof(length));
+            put(name.data(), name.size());
+        }
+        return blob;
+    }
+
+    /**
+     * @brief Renames a results file aside, to the first free `<stem>.<n><extension>`.
+     * @return `false` if it could not be renamed (an error is logged).
+     */
+    static inline bool rotate(const std::filesystem::path& path) {
+        std::error_code ec;
+        std::filesystem::path aside;
+        for (int n = 1; aside.empty() || std::filesystem::exists(aside, ec); ++n) {
+            aside = path.parent_path() / (path.stem().string() + "." + std::to_string(n) + path.extension().string());
+        }
+        std::filesystem::rename(path, aside, ec);
+        if (ec) {
+            std::cerr << "Error: Could not rename " << path.string() << " aside: " << ec.message() << std::endl;
+            return false;
+        }
+        std::cerr << "Warning: Results file " << path.string() << " has different columns; it was renamed to " << aside.string() << "." << std::endl;
+        return true;
+    }
+
+    inline void open(File& file, const std::filesystem::path& path, const std::vector<std::string>& header, const std::vector<ResultField>& row) {
+        file.format = format;
+        if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path());
+        std::error_code ec;
+        bool exists = std::filesystem::exists(path, ec) && std::filesystem::file_size(path, ec) > 0;
+
+        if (format == Format::Binary) {
+            const std::string blob = schema(header, row);
+            if (exists) {
+                std::ifstream in(path, std::ios::binary);
+                std::string existing(blob.size(), '\0');
+                in.read(&existing[0], (std::streamsize) existing.size());
+                in.close();
+                if (existing != blob) {
+                    if (!rotate(path)) return;
+                    exists = false;
+                }
+            }
+            file.out.open(path, std::ios::binary | std::ios::app);
+            if (file.out.is_open() && !exists) file.out.write(blob.data(), (std::streamsize) blob.size());
+            for (const auto& f : row) file.types.push_back(f.type);
+        } else {
+            std::string line;
+            for (size_t c = 0; c < header.size(); ++c) {
+                if (c > 0) line += ';';
+                line += header[c];
+            }
+            if (exists && !header.empty()) {
+                std::ifstream in(path);
+                std::string existing;
+                std::getline(in, existing);
+                if (!existing.empty() && existing.back() == '\r') existing.pop_back();
+                in.close();
+                if (existing != line) {
+                    if (!rotate(path)) return;
+                    exists = false;
+                }
+            }
+            file.out.open(path, std::ios::app);
+            if (file.out.is_open() && !exists) file.out << line;
+            file.empty = !exists && header.empty();
+        }
+
+        file.ok = file.out.is_open();
+        if (!file.ok) std::cerr << "Error: Could not create or open file for appending " << path.string() << std::endl;
+    }
+
+    static inline void writePending(File& file) {
+        if (!file.ok || file.pending.empty()) return;
+        if (file.format == Format::Text) {
+            std::string text;
+            for (const auto& row : file.pending) {
+                if (!file.empty) text += '\n';
+                file.empty = false;
+                for (size_t c = 0; c < row.size(); ++c) {
+                    if (c > 0) text += ';';
+                    text += row[c].str();
+                }
+            }
+            file.out.write(text.data(), (std::streamsize) text.size());
+        } else {
+            writeBatch(file);
+        }
+        file.pending.clear();
+    }
+
+    static inline void writeBatch(File& file) {
+        std::string blob;
+        auto put = [&blob](const void* data, size_t bytes) { blob.append(static_cast<const char*>(data), bytes); };
+        const uint32_t rows = (uint32_t) file.pending.size();
+        put(&rows, sizeof(rows));
+        for (size_t c = 0; c < file.types.size(); ++c) {
+            const ResultField::Type type = file.types[c];
+            if (type == ResultField::Type::Text) {
+                uint32_t offset = 0;
+                put(&offset, sizeof(offset));
+                for (const auto& row : file.pending) {
+                    offset += (uint32_t) (c < row.size() ? row[c].s.size() : 0);
+                    put(&offset, sizeof(offset));
+                }
+                for (const auto& row : file.pending) {
+                    if (c < row.size()) put(row[c].s.data(), row[c].s.size());
+                }
+            } else {
+                for (const auto& row : file.pending) {
+                    const ResultField empty;
+                    const ResultField& f = c < row.size() ? row[c] : empty;
+                    if (type == ResultField::Type::Int)       put(&f.i, sizeof(f.i));
+                    else if (type == ResultField::Type::UInt) put(&f.u, sizeof(f.u));
+                    else                                      put(&f.r, sizeof(f.r));
+                }
+            }
+        }
+        file.out.write(blob.data(), (std::streamsize) blob.size());
+    }
+};
@@ -0,0 +1,295 @@
+#pragma once
+
+#include "DataGenerator.h"
+#include "NetworkResourceAllocation.h"
+#include "SpatialIndex.h"
+#include "utils.h"
+
+#include <charconv>
+#include <cmath>
+#include <fstream>
+
+namespace ScenarioGenerator {
+
+    /**
+     * @enum Distribution
+     * @brief How the points of a layout are spread over the region.
+     */
+    enum class Distribution {
+        Uniform,  ///< Uniformly over the whole region.
+        Hotspots, ///< Gaussian clusters around randomly placed centres.
+        Lines     ///< Along randomly placed segments (roads, rail lines), with Gaussian jitter.
+    };
+
+    /**
+     * @struct Region
+     * @brief A latitude/longitude bounding box.
+     * @details Defaults to the area covered by the base files (`Devices_1000.txt`, `EC_100.txt`).
+     */
+    struct Region {
+        double latMin = 44.23, latMax = 44.92;
+        double lonMin = 10.57, lonMax = 11.31;
+    };
+
+    /**
+     * @struct Layout
+     * @brief The spatial distribution of one kind of entity.
+     */
+    struct Layout {
+        Distribution distribution = Distribution::Uniform;
+        int clusters = 8;       ///< Number of hotspots or lines.
+        double spreadKm = 0.5;  ///< Standard deviation (km) around a hotspot centre or a line.
+    };
+
+    /**
+     * @struct Spec
+     * @brief Everything needed to generate a synthetic scenario.
+     */
+    struct Spec {
+        int devices = 1000;
+        int serversEC = 100;
+        int serversCC = 5;
+        Region region;
+        Layout deviceLayout;
+        Layout serverLayout;
+    };
+
+    namespace {
+        /**
+         * @brief Appends space-separated fields to a text buffer and writes it out in large blocks.
+         */
+        class RowWriter {
+        public:
+            explicit RowWriter(const std::filesystem::path& path) {
+                if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path());
+                out.open(path, std::ios::binary | std::ios::trunc);
+                buffer.reserve(BLOCK + 256);
+            }
+            ~RowWriter() { flush(); }
+
+            inline bool isOpen() const { return out.is_open(); }
+
+            inline RowWriter& field(std::string_view text) { separate(); buffer.append(text); return *this; }
+            inline RowWriter& field(int value) { separate(); append(std::to_chars(scratch, scratch + sizeof(scratch), value)); return *this; }
+            inline RowWriter& field(double value, int precision = 6) {
+                separate();
+                append(std::to_chars(scratch, scratch + sizeof(scratch), value, std::chars_format::fixed, precision));
+                return *this;
+            }
+            inline void endRow() {
+                buffer.push_back('\n');
+                rowStart = true;
+                if (buffer.size() >= BLOCK) flush();
+            }
+            inline bool flush() {
+                out.write(buffer.data(), (std::streamsize) buffer.size());
+                buffer.clear();
+                return (bool) out;
+            }
+
+        private:
+            static constexpr size_t BLOCK = 1 << 20;
+            std::ofstream out;
+            std::string buffer;
+            char scratch[64];
+            bool rowStart = true;
+
+            inline void separate() { if (!rowStart) buffer.push_back(' '); rowStart = false; }
+            inline void append(std::to_chars_result result) { buffer.append(scratch, result.ptr); }
+        };
+
+        /// A standard normal sample (Box-Muller).
+        inline double gaussian(utils::Rng& rng) {
+            const double u1 = 1.0 - utils::randomNumber(rng, 0.0, 1.0);
+            const double u2 = utils::randomNumber(rng, 0.0, 1.0);
+            return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * static_cast<double>(utils::PI_L) * u2);
+        }
+
+        inline double clamp(double value, double low, double high) {
+            return std::min(std::max(value, low), high);
+        }
+    }
+
+    /**
+     * @class PointSampler
+     * @brief Draws locations following a `Layout` inside a `Region`.
+     * @details Hotspot centres and line endpoints are drawn once, at construction, so
+     * every point of the layout shares them. Offsets are converted from km to degrees
+     * at the point's latitude, and points are clamped to the region.
+     */
+    class PointSampler {
+    public:
+        PointSampler(const Region& region_, const Layout& layout_, utils::Rng& rng) : region(region_), layout(layout_) {
+            const int anchors = layout.distribution == Distribution::Uniform ? 0 : std::max(layout.clusters, 1);
+            for (int k = 0; k < anchors; ++k) {
+                starts.push_back(uniform(rng));
+                ends.push_back(layout.distribution == Distribution::Lines ? uniform(rng) : starts.back());
+            }
+        }
+
+        /**
+         * @brief Draws the next point.
+         * @return A `{lat, lon}` pair inside the region.
+         */
+        inline std::pair<double, double> next(utils::Rng& rng) {
+            if (starts.empty()) return uniform(rng);
+
+            const int k = utils::randomNumber(rng, 0, (int) starts.size() - 1);
+            const double t = layout.distribution == Distribution::Lines ? utils::randomNumber(rng, 0.0, 1.0) : 0.0;
+            double lat = starts[k].first + t * (ends[k].first - starts[k].first);
+            double lon = starts[k].second + t * (ends[k].second - starts[k].second);
+
+            const double dLat = layout.spreadKm / SpatialIndex::KM_PER_DEGREE;
+            const double dLon = dLat / std::max(std::cos(lat * SpatialIndex::DEG_TO_RAD), 1e-6);
+            lat = clamp(lat + gaussian(rng) * dLat, region.latMin, region.latMax);
+            lon = clamp(lon + gaussian(rng) * dLon, region.lonMin, region.lonMax);
+            return {lat, lon};
+        }
+
+    private:
+        Region region;
+        Layout layout;
+        std::vector<std::pair<double, double>> starts, ends;
+
+        inline std::pair<double, double> uniform(utils::Rng& rng) const {
+            return {utils::randomNumber(rng, region.latMin, region.latMax), utils::randomNumber(rng, region.lonMin, region.lonMax)};
+        }
+    };
+
+    /**
+     * @brief Writes a synthetic device file of any size.
+     * @details Devices are placed by `spec.deviceLayout` and get a random service from
+     * `DataGenerator::servicesData`, exactly like the rows of `DataGenerator::devicesData`.
+     * The file is streamed to `DataGenerator::devicesFile(spec.devices)`.
+     *
+     * @param[in] spec The scenario to generate.
+     * @param[in,out] rng The random number context to draw from.
+     * @return `true` if the file was written, `false` otherwise (an error is logged).
+     */
+    inline bool writeDevices(const Spec& spec, utils::Rng& rng) {
+        std::vector<std::vector<std::string>> services = DataGenerator::servicesData(rng);
+        if (services.size() <= 1) {
+            std::cerr << "Error: No services data available." << std::endl;
+            return false;
+        }
+
+        const std::filesystem::path path = DataGenerator::devicesFile(spec.devices);
+        RowWriter writer(path);
+        if (!writer.isOpen()) {
+            std::cerr << "Error writing to " << path.string() << std::endl;
+            return false;
+        }
+        writer.field("#").field("LAT").field("LON").field("CND").field("PCC").field("PCN").field("MEM").field("STO").field("S_d").field("SVC").endRow();
+
+        PointSampler sampler(spec.region, spec.deviceLayout, rng);
+        for (int i = 1; i <= spec.devices; ++i) {
+            const auto [lat, lon] = sampler.next(rng);
+            const auto& service = services.at(utils::randomNumber(rng, 1, (int) services.size() - 1));
+            writer.field(i).field(lat).field(lon)
+                  .field(service.at(1)).field(service.at(2)).field(service.at(3)).field(service.at(4))
+                  .field(service.at(5)).field(service.at(6)).field(service.at(0)).endRow();
+        }
+        return writer.flush();
+    }
+
+    /**
+     * @brief Writes synthetic edge and cloud server files of any size.
+     * @details Edge servers are placed by `spec.serverLayout` and draw their hardware
+     * from `DataGenerator::EDGE_PROFILES` with random memory and storage, as in
+     * `DataGenerator::ecData`. Cloud servers cycle through the tiers of the base
+     * `CC_5.txt` file, at its data-centre location. The files are streamed to
+     * `DataGenerator::ecFile` and `DataGenerator::ccFile`.
+     *
+     * @param[in] spec The scenario to generate.
+     * @param[in,out] rng The random number context to draw from.
+     * @return `true` if both files were written, `false` otherwise (an error is logged).
+     */
+    inline bool writeServers(const Spec& spec, utils::Rng& rng) {
+        const std::filesystem::path ecPath = DataGenerator::ecFile(spec.serversEC);
+        {
+            RowWriter writer(ecPath);
+            if (!writer.isOpen()) {
+                std::cerr << "Error writing to " << ecPath.string() << std::endl;
+                return false;
+            }
+            writer.field("#").field("LAT").field("LON").field("CSC").field("PCC").field("PCN").field("MEM").field("STO").field("T_p").endRow();
+
+            PointSampler sampler(spec.region, spec.serverLayout, rng);
+            for (int i = 1; i <= spec.serversEC; ++i) {
+                const auto [lat, lon] = sampler.next(rng);
+                const DataGenerator::EdgeProfile& profile = DataGenerator::EDGE_PROFILES[utils::randomNumber(rng, 1, 5) - 1];
+                double mem = utils::randomNumber(rng, 0.00001, 125.0);
+                double sto = utils::randomNumber(rng, 0.00001, 1000.0);
+                double t_p = 12.5 / std::stod(profile.pcc);
+                writer.field(i).field(lat).field(lon).field(profile.csc).field(profile.pcc).field(profile.pcn)
+                      .field(mem).field(sto).field(t_p).endRow();
+            }
+            if (!writer.flush()) return false;
+        }
+
+        const std::filesystem::path tiersPath = DataGenerator::basePath / "CC_5.txt";
+        auto tiers = FileManager::read(tiersPath.string(), ' ');
+        if (!tiers || tiers->empty()) {
+            std::cerr << "Error: CC source file not found or is empty: " << tiersPath.string() << std::endl;
+            return false;
+        }
+        std::vector<std::vector<std::string>> rows;
+        for (auto& row : *tiers) {
+            if (row.at(0) != "#") rows.push_back(row);
+        }
+
+        const std::filesystem::path ccPath = DataGenerator::ccFile(spec.serversCC);
+        RowWriter writer(ccPath);
+        if (!writer.isOpen() || rows.empty()) {
+            std::cerr << "Error writing to " << ccPath.string() << std::endl;
+            return false;
+        }
+        writer.field("#").field("LAT").field("LON").field("CSC").field("PCC").field("PCN").field("MEM").field("STO").field("T_p").endRow();
+        for (int i = 1; i <= spec.serversCC; ++i) {
+            const auto& tier = rows[(i - 1) % rows.size()];
+            writer.field(i);
+            for (size_t c = 1; c < tier.size(); ++c) writer.field(tier[c]);
+            writer.field(12.5 / std::stod(tier.at(4))).endRow();
+        }
+        return writer.flush();
+    }
+
+    /**
+     * @brief Generates every data file of a synthetic scenario.
+     * @details The files are written to the cache paths the loaders read, so a later
+     * `pre_calculation` with the same sizes loads the synthetic scenario through the fast
+     * parser (and replaces any older snapshot, whose source stamps no longer match).
+     * Delete `data/devices`, `data/servers` and `data/snapshots` to return to the
+     * scenarios sampled from the base files.
+     *
+     * @param[in] spec The scenario to generate.
+     * @param[in,out] rng The random number context to draw from.
+     * @return `true` if all files were written.
+     */
+    inline bool generate(const Spec& spec, utils::Rng& rng) {
+        if (spec.devices <= 0 || spec.serversEC <= 0 || spec.serversCC <= 0) {
+            std::cerr << "Error: Number of devices and servers must be positive." << std::endl;
+            return false;
+        }
+        return writeDevices(spec, rng) && writeServers(spec, rng);
+    }
+
+    /**
+     * @brief Generates a synthetic scenario and pre-calculates its snapshot for each technology.
+     * @details Runs `generate` and then `NetworkResourceAllocation::pre_calculation` once per
+     * technology, which computes coverage and timing and stores the binary snapshot, so
+     * experiments on the scenario start from the snapshot.
+     *
+     * @param[in] spec The scenario to generate.
+     * @param[in] techs The network technology IDs to pre-calculate.
+     * @param[in,out] rng The random number context to draw from.
+     * @return `true` if the files and every snapshot were produced.
+     */
+    inline bool prepare(const Spec& spec, const iVec& techs, utils::Rng& rng) {
+        if (!generate(spec, rng)) return false;
+        for (int tech : techs) {
+            if (!NetworkResourceAllocation::pre_calculation("Synthetic", "Generator", spec.devices, spec.serversEC, spec.serversCC, tech, rng)) return false;
+        }
+        return true;
+    }
+}
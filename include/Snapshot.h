@@ -0,0 +1,257 @@
+#pragma once
+
+#include "DataGenerator.h"
+#include "FileManager.h"
+#include "structs.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace Snapshot {
+
+    constexpr char MAGIC[8] = {'N', 'R', 'A', 'S', 'N', 'A', 'P', '\0'};
+    constexpr uint32_t VERSION = 2;
+    constexpr uint32_t ENDIAN_MARK = 0x01020304;
+
+    static_assert(std::is_trivially_copyable<Device>::value, "Device must be trivially copyable to be snapshotted");
+    static_assert(std::is_trivially_copyable<Server>::value, "Server must be trivially copyable to be snapshotted");
+    static_assert(std::is_trivially_copyable<CandidateTable::CloudRoute>::value, "CloudRoute must be trivially copyable to be snapshotted");
+
+    /**
+     * @struct SourceStamp
+     * @brief Size and modification time of a data file a snapshot was built from.
+     */
+    struct SourceStamp {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+
+        inline bool operator==(const SourceStamp& other) const { return size == other.size && mtime == other.mtime; }
+        inline bool operator!=(const SourceStamp& other) const { return !(*this == other); }
+    };
+
+    /**
+     * @struct Header
+     * @brief The fixed-size header at the start of every snapshot file.
+     * @details Besides the instance dimensions, it records the layout of `Device` and
+     * `Server`, so a snapshot written by a build with different structs is rejected
+     * instead of misread. The sections follow the header in the order of the counts,
+     * each padded to a multiple of 8 bytes.
+     */
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t endian;
+        uint32_t deviceSize;
+        uint32_t serverSize;
+        int32_t devices, serversEC, serversCC, tech;
+        uint64_t deviceCount;    ///< Entries of the `Devices` section (including the placeholder).
+        uint64_t serverCount;    ///< Entries of the `Servers` section (including the placeholder).
+        uint64_t offsetCount;    ///< Entries of the candidate `offsets` and `edgeOffsets` sections.
+        uint64_t candidateCount; ///< Entries of the `serverIds` section.
+        uint64_t edgeCount;      ///< Entries of each per-edge-slot section.
+        uint64_t cloudCount;     ///< Entries of the `cloudProcessing` section.
+        uint64_t legCount;       ///< Entries of the `cloudLegs` section.
+        uint64_t coveredCount;   ///< Entries of the `coveredDevicesIdx` section.
+        double costOfNonCoverage;
+        SourceStamp sources[3];  ///< Devices, EC and CC data files.
+    };
+
+    /**
+     * @brief The pre-calculated scenario restored from a snapshot.
+     */
+    struct Scenario {
+        Devices devices;
+        Servers servers;
+        iVec coveredDevicesIdx;
+        std::shared_ptr<CandidateTable> candidates;
+        double costOfNonCoverage = 0.0;
+    };
+
+    /**
+     * @brief Returns the path of the snapshot of a scenario.
+     * @param[in] key The scenario key, as produced by `Metrics::getBaseFileName` (e.g. "D300_S105_4G").
+     * @return `data/snapshots/{key}.bin`.
+     */
+    inline std::filesystem::path path(const std::string& key) {
+        return DataGenerator::dataPath / "snapshots" / (key + ".bin");
+    }
+
+    /**
+     * @brief Stamps the data files a scenario is loaded from.
+     * @details Missing files get an empty stamp.
+     * @return The stamps of the device, EC and CC files.
+     */
+    inline std::array<SourceStamp, 3> sourceStamps(int numDevices, int numServersEC, int numServersCC) {
+        const std::filesystem::path files[3] = {DataGenerator::devicesFile(numDevices), DataGenerator::ecFile(numServersEC), DataGenerator::ccFile(numServersCC)};
+        std::array<SourceStamp, 3> stamps{};
+        for (int i = 0; i < 3; ++i) {
+            std::error_code ec;
+            auto size = std::filesystem::file_size(files[i], ec);
+            if (ec) continue;
+            auto mtime = std::filesystem::last_write_time(files[i], ec);
+            if (ec) continue;
+            stamps[i].size = size;
+            stamps[i].mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+        }
+        return stamps;
+    }
+
+    namespace {
+        inline size_t padded(size_t bytes) { return (bytes + 7) & ~size_t(7); }
+
+        template <typename T>
+        inline void writeSection(std::ofstream& out, const std::vector<T>& data) {
+            static const char zeros[8] = {};
+            const size_t bytes = data.size() * sizeof(T);
+            if (bytes > 0) out.write(reinterpret_cast<const char*>(data.data()), bytes);
+            out.write(zeros, padded(bytes) - bytes);
+        }
+
+        template <typename T>
+        inline bool readSection(std::string_view file, size_t& pos, uint64_t count, std::vector<T>& data) {
+            const size_t bytes = count * sizeof(T);
+            if (pos + padded(bytes) > file.size()) return false;
+            data.resize(count);
+            if (bytes > 0) std::memcpy(data.data(), file.data() + pos, bytes);
+            pos += padded(bytes);
+            return true;
+        }
+    }
+
+    /**
+     * @brief Writes the pre-calculated state of a scenario to its snapshot file.
+     * @details The file is written next to its final location and renamed into place,
+     * so a reader never sees a partially written snapshot.
+     *
+     * @param[in] state The state right after `coverage()`, before any allocation.
+     * @param[in] costOfNonCoverage The cost of non-coverage computed by `coverage()`.
+     * @param[in] key The scenario key (see `path`).
+     * @return `true` if the snapshot was written, `false` otherwise (an error is logged).
+     */
+    inline bool save(const Result& state, double costOfNonCoverage, const std::string& key) {
+        const Metrics::CommonInputs& in = state.metrics->inputs;
+        const CandidateTable& candidates = *state.candidates;
+
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.endian = ENDIAN_MARK;
+        header.deviceSize = sizeof(Device);
+        header.serverSize = sizeof(Server);
+        header.devices = in.devices;
+        header.serversEC = in.servers_ec;
+        header.serversCC = in.servers_cc;
+        header.tech = in.tech;
+        header.deviceCount = state.devices.size();
+        header.serverCount = state.servers.size();
+        header.offsetCount = candidates.offsets.size();
+        header.candidateCount = candidates.size();
+        header.edgeCount = candidates.edgeDistances.size();
+        header.cloudCount = candidates.cloudProcessing.size();
+        header.legCount = candidates.cloudLegs.size();
+        header.coveredCount = state.coveredDevicesIdx.size();
+        header.costOfNonCoverage = costOfNonCoverage;
+        const auto stamps = sourceStamps(in.devices, in.servers_ec, in.servers_cc);
+        for (int i = 0; i < 3; ++i) header.sources[i] = stamps[i];
+
+        const std::filesystem::path target = path(key);
+        std::filesystem::path temporary = target;
+        temporary += ".tmp";
+        std::filesystem::create_directories(target.parent_path());
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) {
+                std::cerr << "Error: Could not create snapshot " << temporary.string() << std::endl;
+                return false;
+            }
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write("\0\0\0\0\0\0\0", padded(sizeof(header)) - sizeof(header));
+            writeSection(out, state.devices);
+            writeSection(out, state.servers);
+            writeSection(out, candidates.offsets);
+            writeSection(out, candidates.serverIds);
+            writeSection(out, candidates.edgeOffsets);
+            writeSection(out, candidates.edgeDistances);
+            writeSection(out, candidates.edgeResponseTimes);
+            writeSection(out, candidates.routes);
+            writeSection(out, candidates.cloudProcessing);
+            writeSection(out, candidates.cloudLegs);
+            writeSection(out, state.coveredDevicesIdx);
+            if (!out) {
+                std::cerr << "Error: Could not write snapshot " << temporary.string() << std::endl;
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temporary, target, ec);
+        if (ec) {
+            std::cerr << "Error: Could not move snapshot into place: " << ec.message() << std::endl;
+            std::filesystem::remove(temporary, ec);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Loads the snapshot of a scenario, if a valid one exists.
+     * @details The file is memory-mapped and its sections are copied into the state's
+     * vectors. The snapshot is ignored (and later rebuilt) when its version, byte order,
+     * struct layout or instance dimensions differ from the request, when it is truncated,
+     * or when a data file it was built from has changed since.
+     *
+     * @param[in] key The scenario key (see `path`).
+     * @param[in] numDevices The number of devices requested.
+     * @param[in] numServersEC The number of edge servers requested.
+     * @param[in] numServersCC The number of cloud servers requested.
+     * @param[in] tech The network technology ID requested.
+     * @return The restored scenario, or `std::nullopt` if there is no usable snapshot.
+     */
+    inline std::optional<Scenario> load(const std::string& key, int numDevices, int numServersEC, int numServersCC, int tech) {
+        const std::filesystem::path file = path(key);
+        if (!std::filesystem::exists(file)) return std::nullopt;
+
+        FileManager::MappedFile mapped(file.string());
+        if (!mapped.isOpen()) return std::nullopt;
+        const std::string_view view = mapped.view();
+        if (view.size() < sizeof(Header)) return std::nullopt;
+
+        Header header;
+        std::memcpy(&header, view.data(), sizeof(header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.endian != ENDIAN_MARK ||
+            header.deviceSize != sizeof(Device) || header.serverSize != sizeof(Server) ||
+            header.devices != numDevices || header.serversEC != numServersEC || header.serversCC != numServersCC || header.tech != tech) {
+            return std::nullopt;
+        }
+
+        // A snapshot outlives its data files, but not a change to them.
+        const auto stamps = sourceStamps(numDevices, numServersEC, numServersCC);
+        for (int i = 0; i < 3; ++i) {
+            if (stamps[i] != SourceStamp{} && stamps[i] != header.sources[i]) return std::nullopt;
+        }
+
+        Scenario scenario;
+        scenario.candidates = std::make_shared<CandidateTable>();
+        CandidateTable& candidates = *scenario.candidates;
+        size_t pos = padded(sizeof(Header));
+        const bool complete =
+            readSection(view, pos, header.deviceCount, scenario.devices) &&
+            readSection(view, pos, header.serverCount, scenario.servers) &&
+            readSection(view, pos, header.offsetCount, candidates.offsets) &&
+            readSection(view, pos, header.candidateCount, candidates.serverIds) &&
+            readSection(view, pos, header.offsetCount, candidates.edgeOffsets) &&
+            readSection(view, pos, header.edgeCount, candidates.edgeDistances) &&
+            readSection(view, pos, header.edgeCount, candidates.edgeResponseTimes) &&
+            readSection(view, pos, header.deviceCount, candidates.routes) &&
+            readSection(view, pos, header.cloudCount, candidates.cloudProcessing) &&
+            readSection(view, pos, header.legCount, candidates.cloudLegs) &&
+            readSection(view, pos, header.coveredCount, scenario.coveredDevicesIdx);
+        if (!complete || candidates.offsets.size() != scenario.devices.size() + 1) {
+            std::cerr << "Warning: Ignoring truncated snapshot " << file.string() << std::endl;
+            return std::nullopt;
+        }
+        scenario.costOfNonCoverage = header.costOfNonCoverage;
+        return scenario;
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "structs.h"
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * @class StatePool
+ * @brief A fixed set of working copies of one state, restored in place between repetitions.
+ * @details Repeated runs on the same instance (the repetitions of a meta-heuristic)
+ * used to copy the base state once per run, allocating every device, server and
+ * ledger array and cloning the metrics each time. The pool copies the base state into
+ * its slots once; `reset` then restores a slot with `Result::restore`, a few `memcpy`s
+ * into storage the slot already owns. Memory stays constant however many repetitions
+ * run, and slots restored from concurrent threads never contend on the allocator.
+ *
+ * The base state is held by reference and must outlive the pool; it is only read, so
+ * the slots may be reset concurrently as long as each slot is used by one thread.
+ */
+class StatePool {
+public:
+    /**
+     * @brief Copies the base state into every slot.
+     * @param[in] base The state every slot is restored from.
+     * @param[in] slots The number of working copies (at least one).
+     */
+    StatePool(const Result& base, size_t slots) : base(base), states(std::max<size_t>(slots, 1), base) {}
+
+    StatePool(const StatePool&) = delete;
+    StatePool& operator=(const StatePool&) = delete;
+
+    /**
+     * @brief Restores a slot to the base state.
+     * @param[in] slot The slot to restore, in `[0, size())`.
+     * @return The restored working copy.
+     */
+    inline Result& reset(size_t slot) {
+        states[slot].restore(base);
+        return states[slot];
+    }
+
+    inline Result& operator[](size_t slot) { return states[slot]; }
+    inline const Result& origin() const { return base; }
+    inline size_t size() const { return states.size(); }
+
+private:
+    const Result& base;
+    std::vector<Result> states;
+};
@@ -1,10 +1,14 @@
 #pragma once
 
+#include "ResultsSink.h"
 #include "utils.h"
 
+#include <cstdint>
 #include <filesystem>
+#include <limits>
 #include <memory>
-#include <set>
+#include <mutex>
+#include <typeinfo>
 #include <utility>
 
 #define Devices std::vector<Device> ///< A type alias for a vector of Device objects.
@@ -13,6 +17,18 @@
 #define iVec std::vector<int>       ///< A type alias for a vector of integers, typically used for indices.
 #define iiPVec std::vector<iiP>     ///< A type alias for a vector of integer pairs, typically used for index pairs.
 
+// Compact mode (`NRA_COMPACT`, CMake option `COMPACT_TYPES`) stores the attributes of
+// devices, servers and candidates as `float` and the server index of a candidate slot
+// in 16 bits, for scenarios whose states would not otherwise fit in memory many times
+// over. Results then differ from the default build in the last digits.
+#ifdef NRA_COMPACT
+using Real = float;           ///< Type of the real-valued attributes of devices, servers and candidates.
+using ServerIndex = uint16_t; ///< Type of the server index of a candidate slot (at most 65535 servers).
+#else
+using Real = double;
+using ServerIndex = int;
+#endif
+
 /**
  * @struct server_covering
  * @brief Holds pre-calculated data about a potential or assigned server for a device.
@@ -22,33 +38,130 @@
  * in allocation algorithms.
  */
 struct server_covering {
-    int id = 0;                  ///< The unique identifier of the covering server.
-    int id_routing = 0;          ///< The ID of the edge server for routing if this is a cloud server.
-    double distance = 0.0;       ///< Geographic distance from the device to the server (in km).
-    double connectionTime = 0.0; ///< Total network time (propagation + transmission) in ms.
-    double processingTime = 0.0; ///< Time for the server to process the device's task (in ms).
-    double responseTime = 0.0;   ///< Total time: connectionTime + processingTime.
+    ServerIndex id = 0;          ///< The unique identifier of the covering server.
+    ServerIndex id_routing = 0;  ///< The ID of the edge server for routing if this is a cloud server.
+    Real distance = 0.0;         ///< Geographic distance from the device to the server (in km).
+    Real responseTime = 0.0;     ///< Total time: connection + processing (in ms).
 
     server_covering() = default;
-    explicit server_covering(int id_) : id(id_) {}
-    server_covering(int id_, double distance_) : id(id_), distance(distance_) {}
+    explicit server_covering(int id_) : id((ServerIndex) id_) {}
+    server_covering(int id_, double distance_) : id((ServerIndex) id_), distance((Real) distance_) {}
 };
 
 /**
- * @struct server_supply
- * @brief Aggregates the current resource demand on a single server.
- * @details This struct acts as a state tracker for a server's resource consumption.
- * It sums the requirements of all devices currently allocated to the server,
- * allowing for efficient capacity checks when considering a new device allocation.
+ * @struct CandidateTable
+ * @brief Compressed sparse row (CSR) table of the potential servers of every device.
+ * @details The candidates of device `d` occupy the slots `[offsets[d], offsets[d + 1])`:
+ * first its edge servers, then every cloud server. The table is built once by
+ * `coverage()` and is immutable afterwards, so every copy of a `Result` shares it
+ * through a `shared_ptr` and cloning a state never reallocates candidate lists.
+ *
+ * Only the edge slots store their distance and response time. A device reaches every
+ * cloud server through its closest edge server, so its cloud slots are described by
+ * one `CloudRoute` per device and the edge-to-cloud legs, one row per edge server;
+ * `responseTime` and `entry` derive a cloud slot from them, with the same arithmetic
+ * `timeCalculation` used to store. A cloud slot thus costs a server index instead of
+ * 24 bytes, and pre-calculation no longer times |CC| pairs per device.
  */
-struct server_supply {
-    int pcnD = 0;        ///< Demand: Total number of processing cores required.
-    double cndD = 0.0;   ///< Demand: Sum of non-service costs for all served devices.
-    double pccD = 0.0;   ///< Demand: Total processing core capacity required.
-    double memD = 0.0;   ///< Demand: Total memory required.
-    double stoD = 0.0;   ///< Demand: Total storage required.
-    double bwD = 0.0;    ///< Demand: Total bandwidth required.
-    std::set<int> devices_served; ///< Set of unique IDs of devices currently served.
+struct CandidateTable {
+    static constexpr long double SPEED_OF_LIGHT = 299792.458L; ///< Speed of light in km/s.
+    static constexpr double INTER_DC_LATENCY_MS = 111.86;     ///< Latency from Milan to Ohio CC in ms, measured on 2024-12-18.
+
+    /**
+     * @struct CloudRoute
+     * @brief How a covered device reaches the cloud servers.
+     */
+    struct CloudRoute {
+        int edge = 0;              ///< The closest edge server, used for routing.
+        Real distance = 0.0;       ///< Distance (km) to that edge server.
+        Real transmission = 0.0;   ///< Transmission time (ms) of the device's data.
+        Real size = 0.0;           ///< Data size of the device (`s_d`), for the processing time.
+    };
+
+    iVec offsets;                          ///< Start slot of each device's candidates; size is `devices.size() + 1`.
+    std::vector<ServerIndex> serverIds;    ///< Server index of each candidate.
+    iVec edgeOffsets;                      ///< Start of each device's edge slots in the edge arrays; size is `devices.size() + 1`.
+    std::vector<Real> edgeDistances;       ///< Geographic distance (km) of each edge slot.
+    std::vector<Real> edgeResponseTimes;   ///< Total time (ms) of each edge slot: connection + processing.
+    std::vector<CloudRoute> routes;        ///< Cloud route of each device; size is `devices.size()`.
+    std::vector<double> cloudProcessing;   ///< Processing time per data unit (`t_p`) of each cloud server, in slot order.
+    std::vector<double> cloudLegs;         ///< Distance (km) from server `e` to cloud server `k` at `e * cloudCount() + k`.
+
+    inline int first(int d) const { return offsets[d]; }
+    inline int last(int d) const { return offsets[d + 1]; }
+    inline int count(int d) const { return offsets[d + 1] - offsets[d]; }
+    inline size_t size() const { return serverIds.size(); }
+    inline int edgeCount(int d) const { return edgeOffsets[d + 1] - edgeOffsets[d]; }
+    inline int cloudCount() const { return (int) cloudProcessing.size(); }
+
+    /**
+     * @brief Appends the row of a device.
+     * @param[in] edges The edge servers in range, as returned by the coverage grid.
+     * @param[in] cloudServers The cloud servers, added after the edges if the device is covered.
+     */
+    inline void append(const std::vector<server_covering>& edges, const iVec& cloudServers) {
+        for (const server_covering& s : edges) {
+            serverIds.push_back(s.id);
+            edgeDistances.push_back(s.distance);
+            edgeResponseTimes.push_back(s.responseTime);
+        }
+        if (!edges.empty()) serverIds.insert(serverIds.end(), cloudServers.begin(), cloudServers.end());
+        offsets.push_back((int) serverIds.size());
+        edgeOffsets.push_back((int) edgeDistances.size());
+        routes.emplace_back();
+    }
+
+    /**
+     * @brief The response time (ms) of a candidate slot, derived on demand for cloud slots.
+     * @param[in] d The device index.
+     * @param[in] slot A slot of the device.
+     */
+    inline double responseTime(int d, int slot) const {
+        const int k = slot - offsets[d] - edgeCount(d);
+        if (k < 0) return edgeResponseTimes[edgeOffsets[d] + slot - offsets[d]];
+        const CloudRoute& route = routes[d];
+        double processingTime = route.size * cloudProcessing[k];
+        double propagation_dist = route.distance + cloudLegs[(size_t) route.edge * cloudProcessing.size() + k];
+        double propagation_delay_ms = (propagation_dist / SPEED_OF_LIGHT) * 1000.0;
+        double connectionTime = route.transmission + propagation_delay_ms + INTER_DC_LATENCY_MS;
+        return connectionTime + processingTime;
+    }
+
+    /**
+     * @brief Materialises one candidate slot as a `server_covering`.
+     * @param[in] d The device index.
+     * @param[in] slot A slot of the device.
+     * @return The server index, routing id, distance and response time of the slot.
+     */
+    inline server_covering entry(int d, int slot) const {
+        const int e = slot - offsets[d];
+        const bool cloud = e >= edgeCount(d);
+        server_covering s(serverIds[slot], cloud ? 0.0 : edgeDistances[edgeOffsets[d] + e]);
+        s.id_routing = cloud ? routes[d].edge : 0;
+        s.responseTime = responseTime(d, slot);
+        return s;
+    }
+
+    /**
+     * @brief The bytes held by the table's arrays.
+     */
+    inline uint64_t bytes() const {
+        return utils::byteSize(offsets) + utils::byteSize(serverIds) + utils::byteSize(edgeOffsets) + utils::byteSize(edgeDistances) +
+               utils::byteSize(edgeResponseTimes) + utils::byteSize(routes) + utils::byteSize(cloudProcessing) + utils::byteSize(cloudLegs);
+    }
+
+    /**
+     * @brief Finds the slot of a server in a device's candidate list.
+     * @param[in] d The device index.
+     * @param[in] serverId The server index to look for.
+     * @return The slot of the candidate, or -1 if the server cannot serve the device.
+     */
+    inline int find(int d, int serverId) const {
+        for (int slot = first(d); slot < last(d); ++slot) {
+            if (serverIds[slot] == serverId) return slot;
+        }
+        return -1;
+    }
 };
 
 /**
@@ -57,15 +170,16 @@ struct server_supply {
  * @details This struct holds both the static attributes of a device (ID, location,
  * service requirements) and its dynamic state during the simulation, such as whether
  * it is covered, whether it has been served, and to which server it is assigned.
+ * Its potential servers live in the shared `CandidateTable` of the owning `Result`,
+ * so the struct itself owns no heap memory.
  */
 struct Device {
     int id, pcn, svc;
-    double lat, lon, cnd, pcc, mem, sto, s_d;
-    double bw = 0.0;                      ///< Assigned bandwidth based on network technology.
+    Real lat, lon, cnd, pcc, mem, sto, s_d;
+    Real bw = 0.0;                        ///< Assigned bandwidth based on network technology.
     bool covered = false;                 ///< True if within range of at least one edge server.
     bool served = false;                  ///< True if allocated to a server for processing.
     server_covering server;               ///< The server that is ultimately assigned to this device.
-    std::vector<server_covering> servers; ///< List of all potential servers that can serve this device.
 
     Device() : id(0), pcn(0), svc(0), lat(0.0), lon(0.0), cnd(0.0), pcc(0.0), mem(0.0), sto(0.0), s_d(0.0) {}
     Device(int id_, double lat_, double lon_, double cnd_, double pcc_, int pcn_, double mem_, double sto_, double s_d_, int svc_)
@@ -75,87 +189,246 @@ struct Device {
 /**
  * @struct Server
  * @brief Represents a server (Edge or Cloud) with its capacity and current state.
- * @details Holds a server's static capacities (location, cost, resources) and its
- * dynamic state during the simulation, including whether it is active (`on`) and
- * the current aggregated demand on its resources (`supply`).
+ * @details Holds a server's static capacities (location, cost, resources) and whether
+ * it is active (`on`). The remaining capacity while devices are being allocated is
+ * tracked by the `CapacityLedger` of the owning `Result`.
  */
 struct Server {
     int id, pcn;
     char type;
-    double lat, lon, csc, pcc_per_core, pcc_total, mem, sto, t_p;
-    double bw = 0.0;      ///< Maximum bandwidth capacity of the server.
+    Real lat, lon, csc, pcc_per_core, pcc_total, mem, sto, t_p;
+    Real bw = 0.0;        ///< Maximum bandwidth capacity of the server.
     bool on = false;      ///< True if the server is active (serving at least one device).
-    server_supply supply; ///< Current aggregated demand on the server's resources.
 
     Server() : id(0), pcn(0), type(' '), lat(0.0), lon(0.0), csc(0.0), pcc_per_core(0.0), pcc_total(0.0), mem(0.0), sto(0.0), t_p(0.0) {}
     Server(int id_, double lat_, double lon_, double csc_, double pcc_, int pcn_, double mem_, double sto_, double t_p_, char type_)
         : id(id_), pcn(pcn_), type(type_), lat(lat_), lon(lon_), csc(csc_), pcc_per_core(pcc_), pcc_total(pcc_ * pcn_), mem(mem_), sto(sto_), t_p(t_p_) {}
+};
+
+/**
+ * @struct CapacityLedger
+ * @brief Structure-of-arrays tracker of residual server capacity and device assignments.
+ * @details Keeps, for every server, the remaining PCC, PCN, MEM, STO and BW in
+ * contiguous arrays indexed by position in the `Servers` vector, together with the
+ * number of devices it serves. A flat `assignment` array maps each device id to its
+ * server index (0 when unserved). Allocation algorithms go through `canServe`, `assign` and `release`,
+ * which keep `Device::served` and `Server::on` in sync with the ledger.
+ */
+struct CapacityLedger {
+    std::vector<double> pcc; ///< Residual processing core capacity per server.
+    std::vector<int>    pcn; ///< Residual number of processing cores per server.
+    std::vector<double> mem; ///< Residual memory per server.
+    std::vector<double> sto; ///< Residual storage per server.
+    std::vector<double> bw;  ///< Residual bandwidth per server.
+    iVec load;               ///< Number of devices currently served by each server.
+    iVec assignment;         ///< Server index assigned to each device id (0 = unserved).
+
+    CapacityLedger() = default;
+    CapacityLedger(const Devices& devices, const Servers& servers)
+        : pcc(servers.size(), 0.0), pcn(servers.size(), 0), mem(servers.size(), 0.0), sto(servers.size(), 0.0),
+          bw(servers.size(), 0.0), load(servers.size(), 0), assignment(devices.size(), 0) {
+        for (size_t i = 1; i < servers.size(); ++i) {
+            pcc[i] = servers[i].pcc_total;
+            pcn[i] = servers[i].pcn;
+            mem[i] = servers[i].mem;
+            sto[i] = servers[i].sto;
+            bw[i]  = servers[i].bw;
+        }
+    }
 
     /**
-     * @brief Checks if the server has enough available resources to serve a given device.
-     * @details Performs a multi-dimensional capacity check, comparing the server's
-     * remaining resources against the device's requirements for PCC, PCN, MEM,
-     * STO, and BW.
-     * @param[in] device The device to check against the server's available capacity.
-     * @return Returns `true` if the device can be served, `false` otherwise.
+     * @brief Overwrites every lane with those of another ledger of the same instance, without allocating.
+     * @param[in] other The ledger to copy.
      */
-    inline bool canServe(const Device& device) const {
-    return (supply.pccD + device.pcc <= this->pcc_total &&
-            supply.pcnD + device.pcn <= this->pcn &&
-            supply.memD + device.mem <= this->mem &&
-            supply.stoD + device.sto <= this->sto &&
-            supply.bwD  + device.bw  <= this->bw);
+    inline void restore(const CapacityLedger& other) {
+        utils::copyInto(pcc, other.pcc);
+        utils::copyInto(pcn, other.pcn);
+        utils::copyInto(mem, other.mem);
+        utils::copyInto(sto, other.sto);
+        utils::copyInto(bw, other.bw);
+        utils::copyInto(load, other.load);
+        utils::copyInto(assignment, other.assignment);
     }
 
     /**
-     * @brief Allocates a device to this server and consumes its resources.
-     * @details This function updates the server's state by marking it as active (`on`),
-     * updating the device's state to `served`, and adding the device's resource
-     * requirements to the server's total demand (`supply`).
-     * @param[in,out] device The device to be served. Its `served` status is set to true.
-     * @return `true` if the device was added successfully, `false` if it was already present.
+     * @brief The bytes held by the per-server lanes.
      */
-    inline bool addServed(Device& device) { 
-        auto result = supply.devices_served.insert(device.id);
-        if (!result.second) return false;
-        
-        this->on = true;
+    inline uint64_t serverBytes() const {
+        return utils::byteSize(pcc) + utils::byteSize(pcn) + utils::byteSize(mem) + utils::byteSize(sto) + utils::byteSize(bw) + utils::byteSize(load);
+    }
+
+    /**
+     * @brief Checks if a server has enough residual resources to serve a given device.
+     * @details Compares the five resource lanes (PCC, PCN, MEM, STO, BW) without
+     * short-circuiting, so the check compiles to a branch-free sequence of compares.
+     * @param[in] serverIdx The index of the server to check.
+     * @param[in] device The device whose requirements are tested.
+     * @return Returns `true` if the device fits on the server, `false` otherwise.
+     */
+    inline bool canServe(int serverIdx, const Device& device) const {
+        return (device.pcc <= pcc[serverIdx]) &
+               (device.pcn <= pcn[serverIdx]) &
+               (device.mem <= mem[serverIdx]) &
+               (device.sto <= sto[serverIdx]) &
+               (device.bw  <= bw[serverIdx]);
+    }
+
+    /**
+     * @brief Allocates a device to a server and consumes its resources.
+     * @details Records the assignment, subtracts the device's requirements from the
+     * server's residual capacity and marks the device as `served` and the server as `on`.
+     * @param[in,out] device The device to be served.
+     * @param[in,out] servers The server vector; `servers[serverIdx].on` is set to true.
+     * @param[in] serverIdx The index of the server that will serve the device.
+     * @return `true` if the device was added successfully, `false` if it was already assigned.
+     */
+    inline bool assign(Device& device, Servers& servers, int serverIdx) {
+        if (assignment[device.id] != 0) return false;
+
+        assignment[device.id] = serverIdx;
+        load[serverIdx]++;
+        pcc[serverIdx] -= device.pcc;
+        pcn[serverIdx] -= device.pcn;
+        mem[serverIdx] -= device.mem;
+        sto[serverIdx] -= device.sto;
+        bw[serverIdx]  -= device.bw;
+
+        servers[serverIdx].on = true;
         device.served = true;
-        supply.cndD += device.cnd;
-        supply.pccD += device.pcc;
-        supply.pcnD += device.pcn;
-        supply.memD += device.mem;
-        supply.stoD += device.sto;
-        supply.bwD  += device.bw;
         return true;
     }
 
     /**
-     * @brief Deallocates a device from this server, freeing up its resources.
-     * @details Reverses the allocation process. It removes the device's requirements
-     * from the server's demand, updates the device's state to not `served`, and if
-     * the server becomes empty, it is marked as inactive (`on = false`).
-     * @param[in,out] device The device to be removed. Its `served` status is set to false.
-     * @return `true` if the device was found and removed, `false` otherwise.
+     * @brief Deallocates a device from its current server, freeing up its resources.
+     * @details Reverses `assign`. If the server becomes empty, it is marked as inactive.
+     * @param[in,out] device The device to be removed.
+     * @param[in,out] servers The server vector; the old server's `on` flag is updated.
+     * @return `true` if the device was assigned and has been removed, `false` otherwise.
      */
-    inline bool rmvServed(Device& device) {
-    if (supply.devices_served.find(device.id) == supply.devices_served.end()) return false;
-    
-    supply.devices_served.erase(device.id);
-    device.served = false;
-    
-    supply.cndD -= device.cnd;
-    supply.pccD -= device.pcc;
-    supply.pcnD -= device.pcn;
-    supply.memD -= device.mem;
-    supply.stoD -= device.sto;
-    supply.bwD  -= device.bw;
+    inline bool release(Device& device, Servers& servers) {
+        int serverIdx = assignment[device.id];
+        if (serverIdx == 0) return false;
 
-    if (supply.devices_served.empty()) {
-        this->on = false;
+        assignment[device.id] = 0;
+        load[serverIdx]--;
+        pcc[serverIdx] += device.pcc;
+        pcn[serverIdx] += device.pcn;
+        mem[serverIdx] += device.mem;
+        sto[serverIdx] += device.sto;
+        bw[serverIdx]  += device.bw;
+
+        device.served = false;
+        if (load[serverIdx] == 0) {
+            servers[serverIdx].on = false;
+        }
+        return true;
     }
-    return true;
+};
+
+/**
+ * @struct ObjectiveTracker
+ * @brief Incrementally maintained objective terms and counters of an allocation.
+ * @details Mirrors the outputs that `calculateMetrics` used to obtain by scanning every
+ * device and server: the cost of non-service, the cost of servers in use, the number
+ * of devices served on EC/CC, the number of EC/CC servers on and the sum of response
+ * times. Each allocation change updates it in O(1) and reports the resulting change
+ * in cost, so algorithms never have to maintain cost deltas by hand. The cost of
+ * non-coverage is fixed by the pre-calculation and stays in `Metrics`.
+ */
+struct ObjectiveTracker {
+    double cost_of_non_service = 0.0;  ///< Sum of `cnd` over covered but unserved devices.
+    double cost_of_servers_used = 0.0; ///< Sum of `csc` over servers that are on.
+    double response_time_sum = 0.0;    ///< Sum of the response time of every served device.
+    int devices_served_ec = 0;         ///< Devices served by an edge server.
+    int devices_served_cc = 0;         ///< Devices served by a cloud server.
+    int servers_on_ec = 0;             ///< Edge servers that are on.
+    int servers_on_cc = 0;             ///< Cloud servers that are on.
+
+    /**
+     * @brief Recomputes every term from scratch by scanning the allocation state.
+     * @param[in] devices The state of all devices.
+     * @param[in] servers The state of all servers.
+     * @param[in] coveredDevicesIdx A vector of indices for all covered devices.
+     */
+    inline void rebuild(const Devices& devices, const Servers& servers, const iVec& coveredDevicesIdx) {
+        *this = ObjectiveTracker();
+        for (int d_idx : coveredDevicesIdx) {
+            const Device& device = devices[d_idx];
+            if (device.served) {
+                response_time_sum += device.server.responseTime;
+                if (servers[device.server.id].type == 'E') devices_served_ec++;
+                else devices_served_cc++;
+            } else {
+                cost_of_non_service += device.cnd;
+            }
+        }
+        for (size_t i = 1; i < servers.size(); ++i) {
+            if (!servers[i].on) continue;
+            cost_of_servers_used += servers[i].csc;
+            if (servers[i].type == 'E') servers_on_ec++;
+            else servers_on_cc++;
+        }
+    }
+
+    /**
+     * @brief Records that a device has been allocated to a server.
+     * @param[in] device The device that is now served.
+     * @param[in] server The server now serving it.
+     * @param[in] responseTime The response time of this device-server pair.
+     * @param[in] turnedOn True if the server was off before this allocation.
+     * @return The resulting change in cost (non-service + servers used).
+     */
+    inline double assigned(const Device& device, const Server& server, double responseTime, bool turnedOn) {
+        double delta = -device.cnd;
+        cost_of_non_service -= device.cnd;
+        response_time_sum += responseTime;
+        (server.type == 'E' ? devices_served_ec : devices_served_cc)++;
+        if (turnedOn) {
+            delta += server.csc;
+            cost_of_servers_used += server.csc;
+            (server.type == 'E' ? servers_on_ec : servers_on_cc)++;
+        }
+        return delta;
     }
+
+    /**
+     * @brief Records that a device has been removed from a server.
+     * @param[in] device The device that is no longer served.
+     * @param[in] server The server that was serving it.
+     * @param[in] responseTime The response time of this device-server pair.
+     * @param[in] turnedOff True if the server became empty and was switched off.
+     * @return The resulting change in cost (non-service + servers used).
+     */
+    inline double released(const Device& device, const Server& server, double responseTime, bool turnedOff) {
+        double delta = device.cnd;
+        cost_of_non_service += device.cnd;
+        response_time_sum -= responseTime;
+        (server.type == 'E' ? devices_served_ec : devices_served_cc)--;
+        if (turnedOff) {
+            delta -= server.csc;
+            cost_of_servers_used -= server.csc;
+            (server.type == 'E' ? servers_on_ec : servers_on_cc)--;
+        }
+        return delta;
+    }
+
+    /**
+     * @brief Records that a covered, unserved device has joined the instance.
+     * @param[in] device The new device.
+     */
+    inline void added(const Device& device) { cost_of_non_service += device.cnd; }
+
+    /**
+     * @brief Records that a covered, unserved device has left the instance.
+     * @param[in] device The departing device, already released from its server.
+     */
+    inline void removed(const Device& device) { cost_of_non_service -= device.cnd; }
+
+    /**
+     * @brief The part of the cost that allocation decisions can change.
+     * @return The cost of non-service plus the cost of servers used.
+     */
+    inline double allocationCost() const { return cost_of_non_service + cost_of_servers_used; }
 };
 
 /**
@@ -174,6 +447,9 @@ struct Metrics {
         int servers_ec = 0;
         int servers_cc = 0;
         int tech = 0;
+        uint64_t seed = 0;   ///< Seed of the random context that produced this run.
+        uint64_t stream = 0; ///< Stream id of that random context (e.g., the SA repetition).
+        bool bottlenecks = false; ///< Whether `createBottleneck` modified the instance.
     } inputs;
 
     struct CommonOutputs {
@@ -192,8 +468,31 @@ struct Metrics {
         double average_response_time = 0.0;
     } outputs;
 
+    /// Wall-clock time (s) of the set-up phases of the run, shared by every algorithm.
+    struct PhaseTimes {
+        double pre_calculation_sec = 0.0; ///< The whole `pre_calculation`, including snapshot I/O.
+        double load_sec = 0.0;            ///< Reading the data files, or the snapshot.
+        double covering_sec = 0.0;        ///< `findCovering` (0 when restored from a snapshot).
+        double timing_sec = 0.0;          ///< `timeCalculation` (0 when restored from a snapshot).
+    } phases;
+
+    /// Lower bound on the total cost of the instance, set once by `LowerBounds::record` and shared by every run on it.
+    struct LowerBound {
+        std::string method = "None"; ///< "Lagrangian", "LP", or "None" when no bound was computed.
+        double value = 0.0;          ///< Bound on `total_cost`, non-coverage included.
+        double seconds = 0.0;        ///< Wall-clock time of the bound.
+    } bound;
+
+    /// Memory taken by the instance, measured once by `pre_calculation` (see `Result::footprint`) to size nodes before a run.
+    struct Memory {
+        double device_bytes = 0.0;    ///< Bytes per device in a state copy: its `Device`, ledger entry and share of the covered list.
+        double candidate_bytes = 0.0; ///< Bytes per candidate slot of the shared table, its device and cloud arrays included.
+        uint64_t state_bytes = 0;     ///< Bytes one more copy of the state allocates (devices, servers, ledger, covered list).
+        uint64_t table_bytes = 0;     ///< Bytes of the candidate table, shared by every copy.
+    } memory;
+
     Metrics(std::string simulation, std::string algorithm, int d, int s_ec, int s_cc, int t) : simulation_type(std::move(simulation)), algorithm_name(std::move(algorithm)), inputs({d, s_ec, s_cc, t}) {}
-    Metrics(std::string simulation, std::string algorithm, const std::unique_ptr<Metrics>& base) : simulation_type(std::move(simulation)), algorithm_name(std::move(algorithm)), inputs(base->inputs), outputs(base->outputs) {}
+    Metrics(std::string simulation, std::string algorithm, const std::unique_ptr<Metrics>& base) : simulation_type(std::move(simulation)), algorithm_name(std::move(algorithm)), inputs(base->inputs), outputs(base->outputs), phases(base->phases), bound(base->bound), memory(base->memory) {}
     virtual ~Metrics() = default;
     
     /**
@@ -204,6 +503,27 @@ struct Metrics {
         return std::make_unique<Metrics>(*this);
     }
 
+    /**
+     * @brief Overwrites this object with `other`, which has the same concrete type, reusing its storage.
+     * @details The in-place counterpart of `clone`; the strings keep their buffers, so
+     * restoring the metrics of a working copy allocates nothing.
+     */
+    virtual void restore(const Metrics& other) {
+        *this = other;
+    }
+
+    /**
+     * @brief Copies the part every metrics type shares: inputs, outputs, phase times, lower bound and memory.
+     * @details What the constructor from a base metrics object copies, for an object that already exists.
+     */
+    inline void copyResults(const Metrics& other) {
+        inputs = other.inputs;
+        outputs = other.outputs;
+        phases = other.phases;
+        bound = other.bound;
+        memory = other.memory;
+    }
+
     /**
      * @brief Constructs the base directory path for result files.
      * @return A `std::filesystem::path` like `Results/{sim_type}/{algo_name}`.
@@ -220,55 +540,81 @@ struct Metrics {
         return "D" + std::to_string(this->inputs.devices) + "_S" + std::to_string(this->inputs.servers_ec + this->inputs.servers_cc) + "_" + (std::to_string(this->inputs.tech) + "G");
     }
 
+    /**
+     * @brief The relative distance of the total cost to the lower bound.
+     * @return \f$(total\_cost - bound) / total\_cost\f$, NaN when no bound was computed and 0 for a zero cost.
+     */
+    inline double optimalityGap() const {
+        if (bound.method == "None") return std::numeric_limits<double>::quiet_NaN();
+        if (outputs.total_cost <= 0.0) return 0.0;
+        return std::max(0.0, (outputs.total_cost - bound.value) / outputs.total_cost);
+    }
+
     /**
      * @brief Gets the header (column names) for the results file.
      * @return A `std::vector<std::string>` containing the column names.
      */
     virtual std::vector<std::string> getHeader() const {
-        return {"Devices", "Servers", "Tech", "ExeTime", "DCovered", "DServed", "DServedEC", "DServedCC", "SUsed", "SUsedEC", "SUsedCC", "TotalCost", "CostNCoverage", "CostNService", "CostS", "Avg.RTime"};
+        return {"Devices", "Servers", "Tech", "ExeTime", "DCovered", "DServed", "DServedEC", "DServedCC", "SUsed", "SUsedEC", "SUsedCC", "TotalCost", "CostNCoverage", "CostNService", "CostS", "Avg.RTime", "Seed", "Stream", "TPreCalc", "TLoad", "TCovering", "TTiming", "LowerBound", "OptGap", "TBound", "BDevice", "BSlot", "BState", "BTable"};
     }
 
     /**
-     * @brief Serializes the metrics data into a row of strings for file output.
-     * @return A `std::vector<std::string>` containing the metric values as strings.
+     * @brief Serializes the metrics data into a row of typed fields for file output.
+     * @details Percentages keep four decimals and every other real value six, as in the
+     * text results files. Without a lower bound its three columns are NaN (empty cells
+     * in the text format).
+     * @return A `std::vector<ResultField>` with one field per column of `getHeader()`.
      */
-    virtual std::vector<std::string> data() const {
+    virtual std::vector<ResultField> fields() const {
         return {
-            utils::toString(inputs.devices),
-            utils::toString(inputs.servers_ec + inputs.servers_cc),
-            utils::toString(inputs.tech),
-            utils::toString(outputs.execution_time_sec),
-            utils::toPercentageString(outputs.devices_covered_count, inputs.devices),
-            utils::toPercentageString(outputs.devices_served_count, inputs.devices),
-            utils::toPercentageString(outputs.devices_served_ec_count, outputs.devices_served_count),
-            utils::toPercentageString(outputs.devices_served_cc_count, outputs.devices_served_count),
-            utils::toPercentageString(outputs.servers_used_count, inputs.servers_ec + inputs.servers_cc),
-            utils::toPercentageString(outputs.servers_used_ec_count, inputs.servers_ec),
-            utils::toPercentageString(outputs.servers_used_cc_count, inputs.servers_cc),
-            utils::toString(outputs.total_cost),
-            utils::toString(outputs.cost_of_non_coverage),
-            utils::toString(outputs.cost_of_non_service),
-            utils::toString(outputs.cost_of_servers_used),
-            utils::toString(outputs.average_response_time)};
-    }
-
-    /**
-     * @brief Appends the current metrics data to the appropriate results file.
-     * @details Constructs the file path and name, creates the directory if needed,
-     * and appends the serialized data. Adds a header row if the file is new.
-     */
-    inline void saveResultsToFile() const {
-        std::filesystem::path result_path = this->getBaseDirectoryPath() / (this->getBaseFileName() + ".txt");
-
-        std::vector<std::vector<std::string>> content;
-        if (!std::filesystem::exists(result_path)) {
-            content.push_back(this->getHeader());
-        }
+            ResultField::integer(inputs.devices),
+            ResultField::integer(inputs.servers_ec + inputs.servers_cc),
+            ResultField::integer(inputs.tech),
+            ResultField::real(outputs.execution_time_sec),
+            ResultField::real(utils::percentage(outputs.devices_covered_count, inputs.devices), 4),
+            ResultField::real(utils::percentage(outputs.devices_served_count, inputs.devices), 4),
+            ResultField::real(utils::percentage(outputs.devices_served_ec_count, outputs.devices_served_count), 4),
+            ResultField::real(utils::percentage(outputs.devices_served_cc_count, outputs.devices_served_count), 4),
+            ResultField::real(utils::percentage(outputs.servers_used_count, inputs.servers_ec + inputs.servers_cc), 4),
+            ResultField::real(utils::percentage(outputs.servers_used_ec_count, inputs.servers_ec), 4),
+            ResultField::real(utils::percentage(outputs.servers_used_cc_count, inputs.servers_cc), 4),
+            ResultField::real(outputs.total_cost),
+            ResultField::real(outputs.cost_of_non_coverage),
+            ResultField::real(outputs.cost_of_non_service),
+            ResultField::real(outputs.cost_of_servers_used),
+            ResultField::real(outputs.average_response_time),
+            ResultField::unsignedInteger(inputs.seed),
+            ResultField::unsignedInteger(inputs.stream),
+            ResultField::real(phases.pre_calculation_sec),
+            ResultField::real(phases.load_sec),
+            ResultField::real(phases.covering_sec),
+            ResultField::real(phases.timing_sec),
+            ResultField::real(bound.method == "None" ? std::numeric_limits<double>::quiet_NaN() : bound.value),
+            ResultField::real(optimalityGap()),
+            ResultField::real(bound.method == "None" ? std::numeric_limits<double>::quiet_NaN() : bound.seconds),
+            ResultField::real(memory.device_bytes, 1),
+            ResultField::real(memory.candidate_bytes, 1),
+            ResultField::unsignedInteger(memory.state_bytes),
+            ResultField::unsignedInteger(memory.table_bytes)};
+    }
 
-        content.push_back(this->data());
+    /**
+     * @brief Serializes the metrics data into a row of strings for file output.
+     * @return A `std::vector<std::string>` containing the formatted `fields()`.
+     */
+    inline std::vector<std::string> data() const {
+        std::vector<std::string> row;
+        for (const auto& field : this->fields()) row.push_back(field.str());
+        return row;
+    }
 
-        // FileManager::append will create the directory if it doesn't exist.
-        FileManager::append(result_path.string(), content, ';');
+    /**
+     * @brief Queues the current metrics data for the appropriate results file.
+     * @details The row goes to `ResultsSink::global()`, which keeps the file open across
+     * runs, adds a header row when it creates the file and writes rows in batches.
+     */
+    inline void saveResultsToFile() const {
+        ResultsSink::global().write(this->getBaseDirectoryPath(), this->getBaseFileName(), this->getHeader(), this->fields());
     }
 };
 
@@ -280,6 +626,15 @@ struct MathMetrics : public Metrics {
     std::string status = "Unknown";
     double OF = 0.0;
     double gap = 1.0;
+    std::string warm_start = "None"; ///< Algorithm whose solution was passed to the solver as a MIP start.
+
+    /// Wall-clock time (s) of the stages of `minimizeCost`.
+    struct SolverTimes {
+        double build_sec = 0.0;     ///< Variables, objective and constraints.
+        double export_sec = 0.0;    ///< Writing the .lp file (0 unless it is exported).
+        double solve_sec = 0.0;     ///< `cplex.solve()`.
+        double writeback_sec = 0.0; ///< Applying the solution to the state and computing its metrics.
+    } solver;
 
     MathMetrics(std::string simulation, std::string algorithm, int d, int s_ec, int s_cc, int t)
         : Metrics(std::move(simulation), std::move(algorithm), d, s_ec, s_cc, t) {}
@@ -290,19 +645,33 @@ struct MathMetrics : public Metrics {
         return std::make_unique<MathMetrics>(*this);
     }
 
+    void restore(const Metrics& other) override {
+        *this = static_cast<const MathMetrics&>(other);
+    }
+
     std::vector<std::string> getHeader() const override {
         auto header = Metrics::getHeader();
         header.push_back("Status");
         header.push_back("OF");
         header.push_back("GAP");
+        header.push_back("WarmStart");
+        header.push_back("TBuild");
+        header.push_back("TExport");
+        header.push_back("TSolve");
+        header.push_back("TWriteBack");
         return header;
     }
 
-    std::vector<std::string> data() const override {
-        auto row = Metrics::data();
-        row.push_back(status);
-        row.push_back(utils::toString(OF));
-        row.push_back(utils::toString(gap));
+    std::vector<ResultField> fields() const override {
+        auto row = Metrics::fields();
+        row.push_back(ResultField::text(status));
+        row.push_back(ResultField::real(OF));
+        row.push_back(ResultField::real(gap));
+        row.push_back(ResultField::text(warm_start));
+        row.push_back(ResultField::real(solver.build_sec));
+        row.push_back(ResultField::real(solver.export_sec));
+        row.push_back(ResultField::real(solver.solve_sec));
+        row.push_back(ResultField::real(solver.writeback_sec));
         return row;
     }
 };
@@ -320,6 +689,10 @@ struct HeuristicMetrics : public Metrics {
     std::unique_ptr<Metrics> clone() const override {
         return std::make_unique<HeuristicMetrics>(*this);
     }
+
+    void restore(const Metrics& other) override {
+        *this = static_cast<const HeuristicMetrics&>(other);
+    }
 };
 
 /**
@@ -331,6 +704,19 @@ struct MetaHeuristicMetrics : public Metrics {
     double temperature = 0.0;
     double alpha = 0.0;
 
+    /// Neighbor statistics and outcome of the search.
+    struct SearchCounters {
+        uint64_t iterations = 0; ///< Neighbors drawn.
+        uint64_t accepted = 0;   ///< Moves kept (improving, or accepted by the Metropolis rule).
+        uint64_t rejected = 0;   ///< Moves undone by the Metropolis rule (SA only).
+        uint64_t rejected_optima = 0; ///< Local optima not accepted as the next starting point (ILS only).
+        uint64_t infeasible = 0; ///< Draws that found no server with capacity for the device.
+        double search_sec = 0.0; ///< Wall-clock time of the search loop.
+        std::string stop_reason; ///< Why the search ended: "Frozen", "Time", "Iterations" or "Stagnation".
+
+        inline double iterationsPerSecond() const { return search_sec > 0.0 ? iterations / search_sec : 0.0; }
+    } search;
+
     MetaHeuristicMetrics(std::string simulation, std::string algorithm, int d, int s_ec, int s_cc, int t, double temp, double alph, std::string heuristic)
         : Metrics(std::move(simulation), std::move(algorithm), d, s_ec, s_cc, t), temperature(temp), alpha(alph), heuristic_used(std::move(heuristic)) {}
     MetaHeuristicMetrics(std::string simulation, std::string algorithm, const std::unique_ptr<Metrics>& base, double temp, double alph, std::string heuristic)
@@ -340,6 +726,10 @@ struct MetaHeuristicMetrics : public Metrics {
         return std::make_unique<MetaHeuristicMetrics>(*this);
     }
 
+    void restore(const Metrics& other) override {
+        *this = static_cast<const MetaHeuristicMetrics&>(other);
+    }
+
     inline std::filesystem::path getBaseDirectoryPath() const override {
         return Metrics::getBaseDirectoryPath() / this->heuristic_used;
     }
@@ -349,14 +739,28 @@ struct MetaHeuristicMetrics : public Metrics {
         header.push_back("Temperature");
         header.push_back("Alpha");
         header.push_back("Heuristic");
+        header.push_back("Iterations");
+        header.push_back("Accepted");
+        header.push_back("Rejected");
+        header.push_back("RejectedOptima");
+        header.push_back("Infeasible");
+        header.push_back("Iter/s");
+        header.push_back("Stop");
         return header;
     }
 
-    std::vector<std::string> data() const override {
-        auto row = Metrics::data();
-        row.push_back(utils::toString(temperature));
-        row.push_back(utils::toString(alpha));
-        row.push_back(heuristic_used);
+    std::vector<ResultField> fields() const override {
+        auto row = Metrics::fields();
+        row.push_back(ResultField::real(temperature));
+        row.push_back(ResultField::real(alpha));
+        row.push_back(ResultField::text(heuristic_used));
+        row.push_back(ResultField::unsignedInteger(search.iterations));
+        row.push_back(ResultField::unsignedInteger(search.accepted));
+        row.push_back(ResultField::unsignedInteger(search.rejected));
+        row.push_back(ResultField::unsignedInteger(search.rejected_optima));
+        row.push_back(ResultField::unsignedInteger(search.infeasible));
+        row.push_back(ResultField::real(search.iterationsPerSecond(), 1));
+        row.push_back(ResultField::text(search.stop_reason));
         return row;
     }
 };
@@ -365,22 +769,27 @@ struct MetaHeuristicMetrics : public Metrics {
  * @struct Result
  * @brief A container for the complete state of a single simulation instance.
  * @details This struct bundles all necessary data for a simulation run: the vectors of
- * devices and servers, the list of covered device indices, and the metrics
- * object. This design facilitates passing the entire simulation state between
+ * devices and servers, the list of covered device indices, the shared candidate
+ * table, the capacity ledger, the incremental objective tracker and the metrics object. This design facilitates passing the entire simulation state between
  * functions and creating copies for independent runs or neighborhood exploration.
  */
 struct Result {
     Devices devices;
     Servers servers;
     iVec coveredDevicesIdx;
+    std::shared_ptr<const CandidateTable> candidates;
+    CapacityLedger ledger;
+    ObjectiveTracker tracker;
     std::unique_ptr<Metrics> metrics;
 
-    Result(Devices d, Servers s, iVec c, std::unique_ptr<Metrics> m)
-        : devices(std::move(d)), servers(std::move(s)), coveredDevicesIdx(std::move(c)), metrics(std::move(m)) {}
+    Result(Devices d, Servers s, iVec c, std::shared_ptr<const CandidateTable> t, std::unique_ptr<Metrics> m)
+        : devices(std::move(d)), servers(std::move(s)), coveredDevicesIdx(std::move(c)), candidates(std::move(t)), ledger(devices, servers), metrics(std::move(m)) {
+        tracker.rebuild(devices, servers, coveredDevicesIdx);
+    }
 
-    // Custom copy constructor to correctly clone the unique_ptr
+    // Custom copy constructor to correctly clone the unique_ptr; the candidate table is shared.
     Result(const Result& other)
-        : devices(other.devices), servers(other.servers), coveredDevicesIdx(other.coveredDevicesIdx), metrics(other.metrics ? other.metrics->clone() : nullptr) {}
+        : devices(other.devices), servers(other.servers), coveredDevicesIdx(other.coveredDevicesIdx), candidates(other.candidates), ledger(other.ledger), tracker(other.tracker), metrics(other.metrics ? other.metrics->clone() : nullptr) {}
     
     // Custom copy assignment operator
     Result& operator=(const Result& other) {
@@ -388,18 +797,65 @@ struct Result {
             devices = other.devices;
             servers = other.servers;
             coveredDevicesIdx = other.coveredDevicesIdx;
+            candidates = other.candidates;
+            ledger = other.ledger;
+            tracker = other.tracker;
             metrics = other.metrics ? other.metrics->clone() : nullptr;
         }
         return *this;
     }
+
+    /**
+     * @brief Overwrites this state with `other` in place, reusing its storage.
+     * @details Meant for working copies of the same instance, such as the slots of a
+     * `StatePool`: the device, server and ledger arrays then have the same sizes and
+     * each is restored with one `memcpy`, and the metrics are assigned into the
+     * existing object, so nothing is allocated. Arrays of another size, or metrics of
+     * another type, fall back to a regular copy.
+     * @param[in] other The state to copy.
+     */
+    inline void restore(const Result& other) {
+        if (this == &other) return;
+        utils::copyInto(devices, other.devices);
+        utils::copyInto(servers, other.servers);
+        utils::copyInto(coveredDevicesIdx, other.coveredDevicesIdx);
+        if (candidates != other.candidates) candidates = other.candidates;
+        ledger.restore(other.ledger);
+        tracker = other.tracker;
+        if (metrics && other.metrics && typeid(*metrics) == typeid(*other.metrics)) {
+            metrics->restore(*other.metrics);
+        } else {
+            metrics = other.metrics ? other.metrics->clone() : nullptr;
+        }
+    }
+
+    /**
+     * @brief Measures the memory of this state and of its candidate table.
+     * @details Counts the bytes of the arrays a copy of the state allocates, and of the
+     * shared table, by their sizes; the metrics object and allocator overheads are left
+     * out. Multiplying `state_bytes` by the number of concurrent chains (plus one for
+     * the base state) and adding `table_bytes` gives the footprint of a run.
+     */
+    inline Metrics::Memory footprint() const {
+        Metrics::Memory memory;
+        const uint64_t perDevice = utils::byteSize(devices) + utils::byteSize(ledger.assignment) + utils::byteSize(coveredDevicesIdx);
+        memory.state_bytes = perDevice + utils::byteSize(servers) + ledger.serverBytes();
+        memory.device_bytes = devices.size() > 1 ? (double) perDevice / (double) (devices.size() - 1) : 0.0;
+        if (candidates) {
+            memory.table_bytes = candidates->bytes();
+            memory.candidate_bytes = candidates->size() > 0 ? (double) memory.table_bytes / (double) candidates->size() : 0.0;
+        }
+        return memory;
+    }
 };
 
 namespace showStructs {
     /**
      * @brief Displays the detailed information of a single Device instance to the console.
      * @param[in] device The device object to display.
+     * @param[in] candidates The candidate table holding the device's potential servers.
      */
-    inline void showDevice(const Device& device) {
+    inline void showDevice(const Device& device, const CandidateTable& candidates) {
         std::cout << "========== Device ID: " << device.id << " ==========\n"
                   << "  - Location (Lat, Lon):  (" << device.lat << ", " << device.lon << ")\n"
                   << "  - Service ID:           " << device.svc << "\n"
@@ -420,13 +876,13 @@ namespace showStructs {
             std::cout << "  - Assigned Server ID:   None\n";
         }
 
-        std::cout << "  - Potential Servers (" << device.servers.size() << "):\n";
-        if (device.servers.empty()) {
+        std::cout << "  - Potential Servers (" << candidates.count(device.id) << "):\n";
+        if (candidates.count(device.id) == 0) {
             std::cout << "    - None\n";
         } else {
-            for (const auto& s : device.servers) {
-                std::cout << "    - Server ID: " << std::setw(3) << s.id
-                          << " | Response Time: " << std::fixed << std::setprecision(4) << s.responseTime << " ms\n";
+            for (int slot = candidates.first(device.id); slot < candidates.last(device.id); ++slot) {
+                std::cout << "    - Server ID: " << std::setw(3) << candidates.serverIds[slot]
+                          << " | Response Time: " << std::fixed << std::setprecision(4) << candidates.responseTime(device.id, slot) << " ms\n";
             }
         }
         std::cout << "====================================\n" << std::endl;
@@ -435,12 +891,13 @@ namespace showStructs {
     /**
      * @brief Iterates through and displays a vector of Device objects.
      * @param[in] devices The vector of devices to display.
+     * @param[in] candidates The candidate table holding the devices' potential servers.
      */
-    inline void showDevice(const Devices& devices) {
+    inline void showDevice(const Devices& devices, const CandidateTable& candidates) {
         std::cout << "\n--- Displaying " << devices.size() -1 << " Devices ---\n";
         for (const auto& device : devices) {
             if (device.id == 0) continue; // Skip placeholder at index 0
-            showDevice(device);
+            showDevice(device, candidates);
         }
     }
 
@@ -460,25 +917,7 @@ namespace showStructs {
                   << "  - Memory (MEM):        " << server.mem << "\n"
                   << "  - Storage (STO):       " << server.sto << "\n"
                   << "  - Bandwidth (BW):      " << server.bw << " Mbps\n"
-                  << "  - Proc. Time (T_p):    " << server.t_p << "\n\n"
-                  << "  --- Current Demand ---\n"
-                  << "  - Demand (PCC):        " << server.supply.pccD << "\n"
-                  << "  - Demand (PCN):        " << server.supply.pcnD << "\n"
-                  << "  - Demand (MEM):        " << server.supply.memD << "\n"
-                  << "  - Demand (STO):        " << server.supply.stoD << "\n"
-                  << "  - Demand (BW):         " << server.supply.bwD << "\n"
-                  << "  - Devices Served (" << server.supply.devices_served.size() << "): ";
-
-        if (server.supply.devices_served.empty()) {
-            std::cout << "None\n";
-        } else {
-            std::string device_list;
-            for (int device_id : server.supply.devices_served) {
-                device_list += std::to_string(device_id) + ", ";
-            }
-            // Remove trailing comma and space
-            std::cout << device_list.substr(0, device_list.length() - 2) << "\n";
-        }
+                  << "  - Proc. Time (T_p):    " << server.t_p << "\n";
         std::cout << "===============================================\n" << std::endl;
     }
 
@@ -494,9 +933,50 @@ namespace showStructs {
         }
     }
 
+    /**
+     * @brief Displays the allocation state of every server, as tracked by a capacity ledger.
+     * @param[in] servers The vector of servers to display.
+     * @param[in] ledger The capacity ledger holding the servers' residual resources.
+     */
+    inline void showServer(const Servers& servers, const CapacityLedger& ledger) {
+        std::cout << "\n--- Displaying " << servers.size() - 1 << " Servers ---\n";
+        for (size_t s = 1; s < servers.size(); ++s) {
+            const Server& server = servers[s];
+            std::cout << "========== Server ID: " << server.id << " (Type: " << server.type << ") ==========\n"
+                      << "  - Status (ON):         " << (server.on ? "Yes" : "No") << "\n\n"
+                      << "  --- Residual Capacity ---\n"
+                      << "  - Residual (PCC):      " << ledger.pcc[s] << " / " << server.pcc_total << "\n"
+                      << "  - Residual (PCN):      " << ledger.pcn[s] << " / " << server.pcn << "\n"
+                      << "  - Residual (MEM):      " << ledger.mem[s] << " / " << server.mem << "\n"
+                      << "  - Residual (STO):      " << ledger.sto[s] << " / " << server.sto << "\n"
+                      << "  - Residual (BW):       " << ledger.bw[s] << " / " << server.bw << "\n"
+                      << "  - Devices Served (" << ledger.load[s] << "): ";
+
+            std::string device_list;
+            for (size_t d = 1; d < ledger.assignment.size(); ++d) {
+                if (ledger.assignment[d] == (int) s) {
+                    device_list += std::to_string(d) + ", ";
+                }
+            }
+            if (device_list.empty()) {
+                std::cout << "None\n";
+            } else {
+                // Remove trailing comma and space
+                std::cout << device_list.substr(0, device_list.length() - 2) << "\n";
+            }
+            std::cout << "===============================================\n" << std::endl;
+        }
+    }
+
     namespace {
         const int total_width = 62;
         const int label_width = 26; 
+
+        /// Serializes the metrics tables of runs reported from concurrent threads.
+        inline std::mutex& consoleMutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
        
         inline void print_row (const std::string& label, const std::string& value) {
             std::cout << "| " << std::left << std::setw(label_width) << label
@@ -541,6 +1021,16 @@ namespace showStructs {
             print_row("Algorithm", metrics.algorithm_name);
             print_row("Execution Time (s)", utils::toString(out.execution_time_sec, 6));
             print_row("Mobile Technology", std::to_string(in.tech) + "G");
+            print_row("Seed / Stream", std::to_string(in.seed) + " / " + std::to_string(in.stream));
+            const auto& phases = metrics.phases;
+            print_row("Pre-calculation (s)", utils::toString(phases.pre_calculation_sec, 6));
+            print_row("  - Load / Cover / Timing", utils::toString(phases.load_sec, 4) + " / " + utils::toString(phases.covering_sec, 4) + " / " + utils::toString(phases.timing_sec, 4));
+            const auto& memory = metrics.memory;
+            if (memory.state_bytes > 0) {
+                constexpr double MIB = 1024.0 * 1024.0;
+                print_row("Memory (B/device, B/slot)", utils::toString(memory.device_bytes, 1) + " / " + utils::toString(memory.candidate_bytes, 1));
+                print_row("  - State copy / Table", utils::toString(memory.state_bytes / MIB, 2) + " / " + utils::toString(memory.table_bytes / MIB, 2) + " MiB");
+            }
 
             // --- Block 2: Device Stats ---
             print_midle();
@@ -577,6 +1067,10 @@ namespace showStructs {
             print_row("  - Cost Non-Coverage", utils::toString(out.cost_of_non_coverage, 6));
             print_row("  - Cost Non-Service", utils::toString(out.cost_of_non_service, 6));
             print_row("  - Cost Servers Used", utils::toString(out.cost_of_servers_used, 6));
+            if (metrics.bound.method != "None") {
+                print_row("Lower Bound (" + metrics.bound.method + ")", utils::toString(metrics.bound.value, 6) + " (" + utils::toString(metrics.bound.seconds, 4) + " s)");
+                print_row("  - Optimality Gap", utils::toPercentageString(metrics.optimalityGap(), 1.0) + "%");
+            }
 
             // --- Block 5: TR-med ---
             print_midle();
@@ -591,6 +1085,7 @@ namespace showStructs {
      * @param[in] metrics The MathMetrics object to display.
      */
     inline void showMetrics(const MathMetrics& metrics) {
+        std::lock_guard<std::mutex> lock(consoleMutex());
         show_common_metrics(metrics);
 
         print_midle();
@@ -599,6 +1094,8 @@ namespace showStructs {
         print_row("Solver Status", metrics.status);
         print_row("Objective Function (OF)", utils::toString(metrics.OF, 6));
         print_row("MIP Gap", utils::toPercentageString(metrics.gap, 1.0) + "%");
+        print_row("Warm Start", metrics.warm_start);
+        print_row("Build / Export / Solve (s)", utils::toString(metrics.solver.build_sec, 4) + " / " + utils::toString(metrics.solver.export_sec, 4) + " / " + utils::toString(metrics.solver.solve_sec, 4));
         print_header();
     }
 
@@ -607,6 +1104,7 @@ namespace showStructs {
      * @param[in] metrics The HeuristicMetrics object to display.
      */
     inline void showMetrics(const HeuristicMetrics& metrics) {
+        std::lock_guard<std::mutex> lock(consoleMutex());
         show_common_metrics(metrics);
 
         print_header();
@@ -619,6 +1117,7 @@ namespace showStructs {
      * @param[in] metrics The MetaHeuristicMetrics object to display.
      */
     inline void showMetrics(const MetaHeuristicMetrics& metrics) {
+        std::lock_guard<std::mutex> lock(consoleMutex());
         show_common_metrics(metrics);
 
         print_midle();
@@ -627,6 +1126,12 @@ namespace showStructs {
         print_row("Initial Solution", metrics.heuristic_used);
         print_row("Initial Temperature", utils::toString(metrics.temperature, 2));
         print_row("Alpha (Cooling Rate)", utils::toString(metrics.alpha, 2));
+        const auto& search = metrics.search;
+        print_row("Iterations", std::to_string(search.iterations) + " (" + utils::toString(search.iterationsPerSecond(), 0) + "/s)");
+        print_row("  - Accepted / Rejected", std::to_string(search.accepted) + " / " + std::to_string(search.rejected));
+        print_row("  - Infeasible", std::to_string(search.infeasible));
+        if (metrics.algorithm_name == "ILS") print_row("  - Rejected Optima", std::to_string(search.rejected_optima));
+        print_row("Stopped By", search.stop_reason);
         print_header();
     }   
 }
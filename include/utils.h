@@ -1,7 +1,10 @@
 #pragma once
 
 #include <algorithm>
+#include <charconv>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iomanip>
 #include <numeric>
 #include <optional>
@@ -20,10 +23,11 @@ namespace utils {
 
     /**
      * @brief Converts a value of any type to its string representation.
-     * @details This template function uses `std::ostringstream` for conversion. It
-     * includes a compile-time check (`if constexpr`) to apply fixed-point
-     * notation with a specified precision for floating-point types, ensuring
-     * consistent and predictable formatting for numbers.
+     * @details Arithmetic values are formatted with `std::to_chars` into a stack buffer,
+     * floating-point types in fixed-point notation with a specified precision, ensuring
+     * consistent and predictable formatting for numbers. Other types (and values too
+     * large for the buffer) fall back to `std::ostringstream`, which produces the
+     * same text.
      *
      * @tparam T The data type of the value to be converted.
      * @param[in] value The value to convert.
@@ -33,6 +37,18 @@ namespace utils {
      */
     template <typename T>
     inline std::string toString(const T& value, int precision = 6) {
+        constexpr bool isNumber = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char> &&
+                                  !std::is_same_v<T, signed char> && !std::is_same_v<T, unsigned char>;
+        if constexpr (isNumber) {
+            char buffer[64];
+            std::to_chars_result result;
+            if constexpr (std::is_floating_point_v<T>) {
+                result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, precision);
+            } else {
+                result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            }
+            if (result.ec == std::errc()) return std::string(buffer, result.ptr);
+        }
         std::ostringstream out;
         if constexpr (std::is_floating_point_v<T>) {
             out << std::fixed << std::setprecision(precision);
@@ -41,6 +57,16 @@ namespace utils {
         return out.str();
     }
 
+    /**
+     * @brief Calculates `(numerator / denominator) * 100.0`, or 0 when the denominator is zero.
+     * @param[in] numerator The value representing the part of the total.
+     * @param[in] denominator The value representing the total.
+     * @return The percentage.
+     */
+    inline double percentage(double numerator, double denominator) {
+        return denominator == 0 ? 0.0 : (numerator / denominator) * 100.0;
+    }
+
     /**
      * @brief Calculates a percentage and converts it to a formatted string.
      * @details This function computes `(numerator / denominator) * 100.0` and formats
@@ -54,11 +80,7 @@ namespace utils {
      * @return A string representation of the calculated percentage.
      */
     inline std::string toPercentageString(double numerator, double denominator, int precision = 4) {
-        if (denominator == 0) {
-            return toString(0.0, precision);
-        }
-        double percentage = (numerator / denominator) * 100.0;
-        return toString(percentage, precision);
+        return toString(percentage(numerator, denominator), precision);
     }
 
     //=========================================================================
@@ -66,47 +88,130 @@ namespace utils {
     //=========================================================================
 
     /**
-     * @brief Provides a singleton instance of a high-quality random number engine.
-     * @details This function returns a reference to a static `std::mt19937` engine.
-     * The engine is seeded only once during the first call using a
-     * non-deterministic value from `std::random_device`. This ensures that all
-     * random number generation throughout the application shares the same
-     * seeded engine for efficiency. Note: This implementation is not
-     * guaranteed to be thread-safe without external locking.
-     *
-     * @return A reference to the static `mt19937` random engine.
+     * @brief Advances a SplitMix64 state and returns its next output.
+     * @details Used to expand a user seed into the 256-bit state of `Rng` and to
+     * decorrelate stream ids, as recommended by the xoshiro authors.
+     * @param[in,out] x The SplitMix64 state.
+     * @return The next 64-bit output.
      */
-    inline std::mt19937& getEngine() {
-        static std::random_device rd;
-        static std::mt19937 engine(rd());
-        return engine;
+    inline uint64_t splitMix64(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
     }
 
     /**
-     * @brief Generates a random number within a specified inclusive interval `[min, max]`.
-     * @details This function is templated to work for both integral and floating-point
-     * types. It uses `if constexpr` to select the correct uniform distribution
-     * (`std::uniform_int_distribution` or `std::uniform_real_distribution`)
-     * at compile-time.
+     * @brief Draws a non-deterministic 64-bit seed from `std::random_device`.
+     * @return A fresh seed, to be recorded so the run can be replayed.
+     */
+    inline uint64_t randomSeed() {
+        std::random_device rd;
+        return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+    }
+
+    /**
+     * @class Rng
+     * @brief An explicit, seedable random number context (xoshiro256**).
+     * @details Each context is identified by a `seed` and a `stream` id; the pair fully
+     * determines the sequence it produces, so any run can be replayed from the values
+     * recorded in `Metrics`. Contexts with the same seed and different streams are
+     * independent, which lets parallel SA chains draw without sharing state. The
+     * class satisfies *UniformRandomBitGenerator* and can be passed to `std` algorithms.
+     */
+    class Rng {
+    public:
+        using result_type = uint64_t;
+
+        explicit Rng(uint64_t seed = randomSeed(), uint64_t stream = 0) : seed_(seed), stream_(stream) {
+            uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+            for (auto& word : s) word = splitMix64(x);
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~result_type(0); }
+
+        inline result_type operator()() {
+            const uint64_t result = rotl(s[1] * 5, 7) * 9;
+            const uint64_t t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+            return result;
+        }
+
+        /**
+         * @brief Creates an independent context with the same seed and another stream id.
+         * @param[in] stream The stream id of the new context.
+         * @return A new `Rng` for `{seed(), stream}`.
+         */
+        inline Rng split(uint64_t stream) const { return Rng(seed_, stream); }
+
+        inline uint64_t seed() const { return seed_; }
+        inline uint64_t stream() const { return stream_; }
+
+    private:
+        uint64_t seed_;
+        uint64_t stream_;
+        uint64_t s[4];
+
+        static inline uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    };
+
+    /**
+     * @brief Generates a random number within a specified interval.
+     * @details Integral types are drawn from the inclusive interval `[min, max]` with
+     * Lemire's unbiased multiply-and-reject method; floating-point types are drawn
+     * from `[min, max)` using the top 53 bits of one output. No distribution object
+     * is constructed, so the call is cheap enough for millions of SA draws.
      *
      * @tparam T The numeric type (e.g., int, double). Must be an arithmetic type.
-     * @param[in] min The lower bound of the interval (inclusive).
-     * @param[in] max The upper bound of the interval (inclusive).
+     * @param[in,out] rng The random number context to draw from.
+     * @param[in] min The lower bound of the interval.
+     * @param[in] max The upper bound of the interval.
      * @return A random number of type T within the specified range.
      * @throws std::invalid_argument if `min` is greater than `max`.
      */
     template<typename T>
-    inline T randomNumber(T min, T max) {
+    inline T randomNumber(Rng& rng, T min, T max) {
         static_assert(std::is_arithmetic_v<T>, "T must be an arithmetic type.");
         if (min > max) {
             throw std::invalid_argument("Error in randomNumber: min cannot be greater than max.");
         }
         if constexpr (std::is_integral_v<T>) {
-            std::uniform_int_distribution<T> distribution(min, max);
-            return distribution(getEngine());
+            const uint64_t range = static_cast<uint64_t>(max) - static_cast<uint64_t>(min);
+            if (range == ~uint64_t(0)) return static_cast<T>(rng());
+            const uint64_t bound = range + 1;
+            unsigned __int128 m = static_cast<unsigned __int128>(rng()) * bound;
+            uint64_t low = static_cast<uint64_t>(m);
+            if (low < bound) {
+                const uint64_t threshold = (0 - bound) % bound;
+                while (low < threshold) {
+                    m = static_cast<unsigned __int128>(rng()) * bound;
+                    low = static_cast<uint64_t>(m);
+                }
+            }
+            return static_cast<T>(static_cast<uint64_t>(min) + static_cast<uint64_t>(m >> 64));
         } else {
-            std::uniform_real_distribution<T> distribution(min, max);
-            return distribution(getEngine());
+            const double unit = static_cast<double>(rng() >> 11) * 0x1.0p-53;
+            return static_cast<T>(min + (max - min) * unit);
+        }
+    }
+
+    /**
+     * @brief Shuffles a range in place with the Fisher-Yates algorithm.
+     * @param[in,out] rng The random number context to draw from.
+     * @param[in,out] first Iterator to the first element of the range.
+     * @param[in,out] last Iterator past the last element of the range.
+     */
+    template<typename It>
+    inline void shuffle(Rng& rng, It first, It last) {
+        const auto n = static_cast<int64_t>(last - first);
+        for (int64_t i = n - 1; i > 0; --i) {
+            std::iter_swap(first + i, first + randomNumber<int64_t>(rng, 0, i));
         }
     }
 
@@ -114,24 +219,42 @@ namespace utils {
      * @brief Creates a vector of unique integers in random order within an inclusive range `[min, max]`.
      * @details This function first creates a vector and populates it with a sequential
      * range of numbers from `min` to `max` using `std::iota`. It then shuffles
-     * the vector in-place using `std::shuffle` and the shared random engine.
+     * the vector in-place using `utils::shuffle` and the given random context.
      *
      * @tparam T The integral type for the range. Must be an integral type.
+     * @param[in,out] rng The random number context to draw from.
      * @param[in] min The lower bound of the range (inclusive).
      * @param[in] max The upper bound of the range (inclusive).
      * @return A `std::vector<T>` containing all integers from `min` to `max`, randomly shuffled.
      * @throws std::invalid_argument if `min` is greater than `max`.
      */
     template<typename T>
-    inline std::vector<T> shuffledRange(T min, T max) {
+    inline std::vector<T> shuffledRange(Rng& rng, T min, T max) {
+        std::vector<T> numbers;
+        shuffledRange(rng, min, max, numbers);
+        return numbers;
+    }
+
+    /**
+     * @brief Fills `numbers` with the integers of `[min, max]` in random order, reusing its storage.
+     * @details Draws exactly what the returning overload draws, so both give the same
+     * order; a caller that keeps `numbers` across calls allocates only when the range
+     * outgrows it.
+     * @param[in,out] rng The random number context to draw from.
+     * @param[in] min The lower bound of the range (inclusive).
+     * @param[in] max The upper bound of the range (inclusive).
+     * @param[out] numbers The shuffled range.
+     * @throws std::invalid_argument if `min` is greater than `max`.
+     */
+    template<typename T>
+    inline void shuffledRange(Rng& rng, T min, T max, std::vector<T>& numbers) {
         static_assert(std::is_integral_v<T>, "shuffledRange requires an integral type.");
         if (min > max) {
             throw std::invalid_argument("Error in shuffledRange: min cannot be greater than max.");
         }
-        std::vector<T> numbers(max - min + 1);
+        numbers.resize(max - min + 1);
         std::iota(numbers.begin(), numbers.end(), min);
-        std::shuffle(numbers.begin(), numbers.end(), getEngine());
-        return numbers;
+        shuffle(rng, numbers.begin(), numbers.end());
     }
 
     //=========================================================================
@@ -141,12 +264,16 @@ namespace utils {
     namespace details {
         /**
          * @brief Internal implementation for sorting indices. Do not call directly.
+         * @details The indices are valid by construction (the full range or a subset the
+         * caller took from the same container), so the comparator reads the entities
+         * unchecked; the order direction is a template parameter, so it costs no branch either.
          */
         template <bool Ascending, typename T, typename AttributeType, AttributeType T::* AttributePtr>
         void sort_indices_impl(const std::vector<T>& entities, std::vector<int>& idxs) {
-            std::sort(idxs.begin(), idxs.end(), [&](int i, int j) {
-                const auto& attr_i = entities.at(i).*AttributePtr;
-                const auto& attr_j = entities.at(j).*AttributePtr;
+            const T* data = entities.data();
+            std::sort(idxs.begin(), idxs.end(), [data](int i, int j) {
+                const auto& attr_i = data[i].*AttributePtr;
+                const auto& attr_j = data[j].*AttributePtr;
 
                 if (attr_i != attr_j) {
                     if constexpr (Ascending) {
@@ -201,6 +328,142 @@ namespace utils {
         return idxs;
     }
 
+    //=========================================================================
+    // Container Utilities
+    //=========================================================================
+
+    /**
+     * @brief The bytes held by the elements of a vector (its size, not its capacity).
+     */
+    template <typename T>
+    inline uint64_t byteSize(const std::vector<T>& values) {
+        return (uint64_t) values.size() * sizeof(T);
+    }
+
+    /**
+     * @brief Copies a vector of plain values into another, reusing the destination's storage.
+     * @details When both vectors have the same size (the usual case when restoring a
+     * working copy of the same instance), the elements are copied with a single
+     * `memcpy` and nothing is allocated; otherwise `dst` is assigned and may reallocate.
+     * @tparam T A trivially copyable element type.
+     * @param[out] dst The vector to overwrite.
+     * @param[in] src The vector to copy.
+     */
+    template <typename T>
+    inline void copyInto(std::vector<T>& dst, const std::vector<T>& src) {
+        static_assert(std::is_trivially_copyable<T>::value, "copyInto copies raw bytes");
+        if (dst.size() != src.size()) {
+            dst = src;
+        } else if (!src.empty()) {
+            std::memcpy(dst.data(), src.data(), src.size() * sizeof(T));
+        }
+    }
+
+    /**
+     * @class IndexedPriorityQueue
+     * @brief A binary max-heap over the integer ids `[0, capacity)` with updatable keys.
+     * @details Each id is in the queue at most once, and its position is tracked so that
+     * `update` and `erase` run in O(log n) without searching. Equal keys are ordered by
+     * ascending id, so the pop order is deterministic.
+     * @tparam Key The priority type; compared with `<` (e.g., `double` or a `std::pair`).
+     */
+    template <typename Key>
+    class IndexedPriorityQueue {
+    public:
+        explicit IndexedPriorityQueue(size_t capacity) : keys(capacity), position(capacity, -1) {}
+
+        inline bool empty() const { return heap.empty(); }
+        inline size_t size() const { return heap.size(); }
+        inline bool contains(int id) const { return position[id] >= 0; }
+
+        /// The id with the highest key. The queue must not be empty.
+        inline int top() const { return heap.front(); }
+        inline const Key& key(int id) const { return keys[id]; }
+
+        /**
+         * @brief Inserts an id, or changes its key if it is already queued.
+         */
+        inline void update(int id, const Key& key) {
+            if (!contains(id)) {
+                keys[id] = key;
+                position[id] = (int) heap.size();
+                heap.push_back(id);
+                siftUp(position[id]);
+                return;
+            }
+            const bool raised = keys[id] < key;
+            keys[id] = key;
+            if (raised) siftUp(position[id]);
+            else siftDown(position[id]);
+        }
+
+        /**
+         * @brief Removes the id with the highest key and returns it.
+         */
+        inline int pop() {
+            const int id = heap.front();
+            erase(id);
+            return id;
+        }
+
+        /**
+         * @brief Removes an id, if it is queued.
+         */
+        inline void erase(int id) {
+            const int at = position[id];
+            if (at < 0) return;
+            const int last = heap.back();
+            heap.pop_back();
+            position[id] = -1;
+            if (last == id) return;
+            heap[at] = last;
+            position[last] = at;
+            siftUp(at);
+            siftDown(position[last]);
+        }
+
+    private:
+        std::vector<Key> keys;
+        std::vector<int> position; ///< Index of each id in `heap`, or -1.
+        std::vector<int> heap;
+
+        inline bool before(int a, int b) const {
+            if (keys[b] < keys[a]) return true;
+            if (keys[a] < keys[b]) return false;
+            return a < b;
+        }
+
+        inline void place(int at, int id) {
+            heap[at] = id;
+            position[id] = at;
+        }
+
+        inline void siftUp(int at) {
+            const int id = heap[at];
+            while (at > 0) {
+                const int parent = (at - 1) / 2;
+                if (!before(id, heap[parent])) break;
+                place(at, heap[parent]);
+                at = parent;
+            }
+            place(at, id);
+        }
+
+        inline void siftDown(int at) {
+            const int id = heap[at];
+            const int n = (int) heap.size();
+            while (true) {
+                int child = 2 * at + 1;
+                if (child >= n) break;
+                if (child + 1 < n && before(heap[child + 1], heap[child])) ++child;
+                if (!before(heap[child], id)) break;
+                place(at, heap[child]);
+                at = child;
+            }
+            place(at, id);
+        }
+    };
+
     //=========================================================================
     // Geographic Utilities
     //=========================================================================
@@ -0,0 +1,335 @@
+#include "NetworkResourceAllocation.h"
+#include "Heuristics.h"
+#include "MetaHeuristics.h"
+#include "ScenarioGenerator.h"
+#ifdef BENCHMARK_WITH_CPLEX
+#include "MathModels.h"
+#endif
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+//=============================================================================
+// Allocation counting
+// Every global operator new of this program goes through these replacements, so the
+// harness can report allocations per operation. Memory obtained directly with malloc
+// (e.g., inside the CPLEX libraries) is not counted.
+//=============================================================================
+
+namespace {
+    std::atomic<uint64_t> allocationCount{0};
+    std::atomic<uint64_t> allocatedBytes{0};
+}
+
+// GCC pairs these replacements with the library's new/delete once they are inlined and
+// flags the free of every counted allocation (-Wmismatched-new-delete); the pairs match.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#pragma GCC diagnostic pop
+
+namespace Benchmark {
+
+    /**
+     * @struct Options
+     * @brief Command-line settings of a benchmark run.
+     */
+    struct Options {
+        iVec sizes = {300, 1000, 10000}; ///< Numbers of devices of the instances to benchmark.
+        int tech = 4;                    ///< Network technology ID of every instance.
+        double minTime = 0.5;            ///< Minimum measured time (s) per benchmark.
+        size_t maxIterations = 100000;   ///< Upper bound on the iterations per benchmark.
+        std::string filter;              ///< Only run benchmarks whose name contains this text.
+        std::string traceFile;           ///< Chrome trace of every timed phase; empty disables it.
+        bool help = false;               ///< Print the usage and exit.
+    };
+
+    /**
+     * @struct Sample
+     * @brief The measurement of one benchmark on one instance.
+     */
+    struct Sample {
+        size_t iterations = 0;
+        double nsPerOp = 0.0;
+        double allocsPerOp = 0.0;
+        double bytesPerOp = 0.0;
+        long peakRssKiB = 0;
+    };
+
+    /**
+     * @brief Returns the peak resident set size of the process so far, in KiB.
+     */
+    inline long peakRssKiB() {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+        return usage.ru_maxrss;
+    }
+
+    /**
+     * @brief Times an operation, excluding the preparation of its input.
+     * @details `setup()` builds a fresh input for every iteration (operations usually
+     * consume or modify it) and only `op(input)` is timed. After one warm-up iteration,
+     * iterations are repeated until `minTime` seconds of operation time have been
+     * measured or `maxIterations` is reached. Allocations are counted around `op` only.
+     *
+     * @param[in] options The timing budget of the run.
+     * @param[in] setup A callable returning the input of one iteration.
+     * @param[in] op A callable taking that input by reference.
+     * @return The per-operation averages.
+     */
+    template <typename Setup, typename Op>
+    inline Sample measure(const Options& options, Setup&& setup, Op&& op) {
+        using clock = std::chrono::steady_clock;
+        {
+            auto input = setup();
+            op(input);
+        }
+
+        Sample sample;
+        double elapsedSec = 0.0;
+        uint64_t allocations = 0, bytes = 0;
+        while (sample.iterations < options.maxIterations && (elapsedSec < options.minTime || sample.iterations == 0)) {
+            auto input = setup();
+            const uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+            const uint64_t bytesBefore = allocatedBytes.load(std::memory_order_relaxed);
+            const auto start = clock::now();
+            op(input);
+            const auto end = clock::now();
+            allocations += allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+            bytes += allocatedBytes.load(std::memory_order_relaxed) - bytesBefore;
+            elapsedSec += std::chrono::duration<double>(end - start).count();
+            ++sample.iterations;
+        }
+
+        const double n = static_cast<double>(sample.iterations);
+        sample.nsPerOp = elapsedSec * 1e9 / n;
+        sample.allocsPerOp = allocations / n;
+        sample.bytesPerOp = bytes / n;
+        sample.peakRssKiB = peakRssKiB();
+        return sample;
+    }
+
+    inline void printHeader() {
+        std::printf("%-34s %8s %10s %16s %12s %14s %14s\n", "Benchmark", "Devices", "Iterations", "ns/op", "allocs/op", "bytes/op", "peak RSS (KiB)");
+        std::printf("%s\n", std::string(114, '-').c_str());
+    }
+
+    inline void printSample(const std::string& name, int devices, const Sample& sample) {
+        std::printf("%-34s %8d %10zu %16.0f %12.1f %14.0f %14ld\n", name.c_str(), devices, sample.iterations, sample.nsPerOp, sample.allocsPerOp, sample.bytesPerOp, sample.peakRssKiB);
+        std::fflush(stdout);
+    }
+
+    /**
+     * @struct Instance
+     * @brief The data files of one benchmarked instance.
+     * @details Up to 1000 devices the instance is sampled from the base files, like the
+     * simulations in `main.cpp`, with 100 edge and 5 cloud servers. Larger instances are
+     * synthetic (`ScenarioGenerator`), with one edge server per 10 devices; their files
+     * are generated once and reused by later runs.
+     */
+    struct Instance {
+        int devices;
+        int serversEC;
+        int serversCC;
+        int tech;
+
+        Instance(int numDevices, int techType)
+            : devices(numDevices), serversEC(numDevices <= 1000 ? 100 : numDevices / 10), serversCC(5), tech(techType) {}
+
+        inline bool prepare(utils::Rng& rng) const {
+            if (devices <= 1000) return true;
+            if (std::filesystem::exists(DataGenerator::devicesFile(devices)) && std::filesystem::exists(DataGenerator::ecFile(serversEC)) &&
+                std::filesystem::exists(DataGenerator::ccFile(serversCC))) {
+                return true;
+            }
+            ScenarioGenerator::Spec spec;
+            spec.devices = devices;
+            spec.serversEC = serversEC;
+            spec.serversCC = serversCC;
+            spec.deviceLayout.distribution = ScenarioGenerator::Distribution::Hotspots;
+            return ScenarioGenerator::generate(spec, rng);
+        }
+    };
+
+    /**
+     * @brief Runs every benchmark selected by the filter on one instance.
+     * @param[in] instance The instance to benchmark.
+     * @param[in] options The run settings.
+     * @param[in,out] rng The random number context of the randomized operations.
+     * @return `false` if the instance could not be prepared.
+     */
+    inline bool runInstance(const Instance& instance, const Options& options, utils::Rng& rng) {
+        const int D = instance.devices;
+        auto selected = [&options](const std::string& name) { return options.filter.empty() || name.find(options.filter) != std::string::npos; };
+        auto bench = [&](const std::string& name, auto&& setup, auto&& op) {
+            if (selected(name)) printSample(name, D, measure(options, setup, op));
+        };
+
+        if (!instance.prepare(rng)) return false;
+        auto base = NetworkResourceAllocation::pre_calculation("Benchmark", "Benchmark", D, instance.serversEC, instance.serversCC, instance.tech, rng);
+        if (!base) return false;
+        const Result& state = *base;
+
+        // --- Pre-calculation phase ---
+        struct NoInput {};
+        bench("pre_calculation/parse", [] { return NoInput{}; }, [&](NoInput&) {
+            NetworkResourceAllocation::pre_calculation("Benchmark", "Benchmark", D, instance.serversEC, instance.serversCC, instance.tech, rng, false);
+        });
+        bench("pre_calculation/snapshot", [] { return NoInput{}; }, [&](NoInput&) {
+            NetworkResourceAllocation::pre_calculation("Benchmark", "Benchmark", D, instance.serversEC, instance.serversCC, instance.tech, rng);
+        });
+
+        struct CoverageInput {
+            Devices devices;
+            Servers servers;
+            Metrics metrics;
+            CandidateTable candidates;
+        };
+        Devices loadedDevices = NetworkResourceAllocation::loadDevices(D, rng);
+        Servers loadedServers = NetworkResourceAllocation::loadServers(instance.serversEC, instance.serversCC, rng);
+        const auto techProps = NetworkResourceAllocation::techParams(instance.tech);
+        NetworkResourceAllocation::bandwidth(loadedDevices, loadedServers, techProps.second);
+        auto coverageInput = [&] { return CoverageInput{loadedDevices, loadedServers, Metrics("Benchmark", "Benchmark", D, instance.serversEC, instance.serversCC, instance.tech), CandidateTable()}; };
+
+        bench("findCovering", coverageInput, [&](CoverageInput& in) {
+            NetworkResourceAllocation::findCovering(in.devices, in.servers, techProps.first, in.metrics, in.candidates);
+        });
+        bench("timeCalculation", [&] { return std::make_shared<CandidateTable>(*state.candidates); }, [&](std::shared_ptr<CandidateTable>& candidates) {
+            NetworkResourceAllocation::timeCalculation(state.devices, state.servers, *candidates);
+        });
+
+        // --- Allocation engines ---
+        std::vector<std::string> heuristics = Heuristics::names();
+        heuristics.push_back("Regret_3");
+        for (const std::string& heuristic : heuristics) {
+            const std::optional<Heuristics::Algorithm> algorithm = Heuristics::resolve(heuristic);
+            if (!algorithm) continue;
+            bench("Heuristics/" + heuristic, [&] { return state; }, [&](Result& copy) {
+                Heuristics::run(*algorithm, copy, rng);
+            });
+        }
+
+        auto seeded = [&] {
+            Result copy = state;
+            Heuristics::run("Greedy_DescAsc", copy, rng);
+            return copy;
+        };
+        for (const std::string metaheuristic : {"SA", "Tabu", "ILS"}) {
+            bench("MetaHeuristics/" + metaheuristic + " chain", seeded, [&](Result& copy) {
+                MetaHeuristics::run(metaheuristic, copy, 100.0, 0.95, rng.split(1));
+            });
+        }
+
+#ifdef BENCHMARK_WITH_CPLEX
+        bench("MathModels/build", [] { return NoInput{}; }, [&](NoInput&) {
+            IloEnv env;
+            try {
+                MathModels::buildCostModel(env, state, false);
+            } catch (const IloException& e) {
+                std::cerr << "CPLEX Error: " << e.getMessage() << std::endl;
+            }
+            env.end();
+        });
+#endif
+        return true;
+    }
+
+    inline void printUsage() {
+        std::printf("Usage: benchmark_app [--sizes 300,1000,10000] [--tech 4] [--min-time 0.5] [--max-iterations 100000]\n"
+                    "                     [--filter <text>] [--trace <file.json>] [--help]\n");
+    }
+
+    /**
+     * @brief Parses the command line.
+     * @details Accepted flags: `--sizes 300,1000,10000`, `--tech 4`, `--min-time 0.5`,
+     * `--max-iterations 100000`, `--filter <text>`, `--trace <file.json>` and `--help`.
+     * @return The options, or `std::nullopt` on an unknown flag or a missing value.
+     */
+    inline std::optional<Options> parseArguments(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            const std::string flag = argv[i];
+            if (flag == "--help" || flag == "-h") {
+                options.help = true;
+                return options;
+            }
+            if (i + 1 >= argc) {
+                std::cerr << "Error: Missing value for " << flag << std::endl;
+                return std::nullopt;
+            }
+            const std::string value = argv[++i];
+            if (flag == "--sizes") {
+                options.sizes.clear();
+                std::stringstream list(value);
+                std::string item;
+                while (std::getline(list, item, ',')) {
+                    if (!item.empty()) options.sizes.push_back(std::stoi(item));
+                }
+            } else if (flag == "--tech") {
+                options.tech = std::stoi(value);
+            } else if (flag == "--min-time") {
+                options.minTime = std::stod(value);
+            } else if (flag == "--max-iterations") {
+                options.maxIterations = std::max<size_t>(1, std::stoul(value));
+            } else if (flag == "--filter") {
+                options.filter = value;
+            } else if (flag == "--trace") {
+                options.traceFile = value;
+            } else {
+                std::cerr << "Error: Unknown option " << flag << std::endl;
+                return std::nullopt;
+            }
+        }
+        return options;
+    }
+}
+
+/**
+ * @brief Times the allocation engines on instances of increasing size.
+ * @details For each instance size, prints one row per benchmark with the mean time
+ * per operation, the heap allocations (count and bytes) per operation and the peak
+ * resident set size of the process after the benchmark.
+ */
+int main(int argc, char** argv) {
+    try {
+        auto options = Benchmark::parseArguments(argc, argv);
+        if (!options) {
+            Benchmark::printUsage();
+            return 1;
+        }
+        if (options->help) {
+            Benchmark::printUsage();
+            return 0;
+        }
+
+        if (!options->traceFile.empty()) Profiling::Trace::global().enable(options->traceFile);
+
+        utils::Rng rng(42);
+        std::printf("Threads: %u, minimum time per benchmark: %.2f s\n\n", Parallel::defaultThreads(), options->minTime);
+        Benchmark::printHeader();
+        for (int size : options->sizes) {
+            if (!Benchmark::runInstance(Benchmark::Instance(size, options->tech), *options, rng)) {
+                std::cerr << "Error: Could not prepare the instance with " << size << " devices." << std::endl;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -2,14 +2,19 @@
 #include "Heuristics.h"
 #include "MetaHeuristics.h"
 #include "MathModels.h"
+#include "ExperimentRunner.h"
+#include "InstanceCache.h"
+#include "Online.h"
 
 /**
  * @brief Initializes and runs a complete simulation flow for a given algorithm.
- * @details This function serves as a high-level controller. It first calls the
- * `pre_calculation` step to load data and prepare the initial simulation
- * state. It can optionally activate a bottleneck scenario for testing purposes
- * by modifying the state before dispatching it to the appropriate `bootup`
- * function. When enabled, the bottleneck creation is deterministic.
+ * @details This function serves as a high-level controller. It takes the prepared
+ * instance from `InstanceCache::global()`, which runs the `pre_calculation` step
+ * (and, optionally, a bottleneck scenario for testing purposes) only the first time a
+ * (sizes, technology, bottleneck, seed) combination is requested, and dispatches a
+ * private copy of it to the appropriate `bootup` function. Calls with the same
+ * arguments and seed therefore run on the very same instance and random stream.
+ * When enabled, the bottleneck creation is deterministic.
  *
  * @param[in] simulation The type of simulation to run (e.g., "Mathematical").
  * @param[in] algorithm The specific algorithm to execute (e.g., "Minimize_Cost").
@@ -22,22 +27,28 @@
  * Defaults to false.
  * @param[in] heuristic The heuristic for generating an initial solution, used
  * mainly by MetaHeuristic simulations. Defaults to "Random".
+ * @param[in] seed The seed of the run's random context. It is recorded in every
+ * metrics row, so passing it back replays the run. Defaults to a fresh random seed;
+ * pass the same seed to compare algorithms on the same instance.
  */
-void initializeSimulation(std::string simulation, std::string algorithm, int numDevices, int numServersEC, int numServersCC, int techType, bool bottlenecks = false, std::string heuristic = "Random") {
-    auto state = NetworkResourceAllocation::pre_calculation(simulation, algorithm, numDevices, numServersEC, numServersCC, techType);
+void initializeSimulation(std::string simulation, std::string algorithm, int numDevices, int numServersEC, int numServersCC, int techType, bool bottlenecks = false, std::string heuristic = "Random", uint64_t seed = utils::randomSeed()) {
+    auto instance = InstanceCache::global().acquire({numDevices, numServersEC, numServersCC, techType, bottlenecks, seed});
 
-    if (bottlenecks) NetworkResourceAllocation::createBottleneck(state, false);
-    
-    if (state) {
+    if (instance) {
+        Result& state = instance->state;
+        utils::Rng& rng = instance->rng;
         if (simulation == "Mathematical") {
-            MathModels::bootup(algorithm, *state);
+            MathModels::bootup(algorithm, state, rng);
         } else if (simulation == "Heuristic") {
-            Heuristics::bootup(algorithm, *state);
+            Heuristics::bootup(algorithm, state, rng);
         } else if (simulation == "MetaHeuristic") {
             int loopTest = 120;
             double T = 100.0;
             double alpha = 0.95;
-            MetaHeuristics::bootup(algorithm, *state, T, alpha, heuristic, loopTest);
+            MetaHeuristics::bootup(algorithm, state, T, alpha, heuristic, loopTest, rng);
+        } else if (simulation == "Online") {
+            int events = 1000;
+            Online::bootup(algorithm, state, events, rng);
         } else {
             std::cerr << "Erro: Tipo de simulação desconhecido." << std::endl;
         }
@@ -47,31 +58,86 @@ void initializeSimulation(std::string simulation, std::string algorithm, int num
     
 }
 
+/**
+ * @brief Prepares several instance sizes and solves them concurrently with a mathematical model.
+ * @details Every instance comes from `InstanceCache::global()`, like in
+ * `initializeSimulation`, so later runs with the same seed reuse it. The prepared states are then handed
+ * to `MathModels::bootupBatch`, which solves them side by side, each in its own CPLEX
+ * environment, splitting the available cores between them.
+ *
+ * @param[in] algorithm The mathematical model to execute (e.g., "Minimize_Cost").
+ * @param[in] deviceCounts The number of devices of each instance.
+ * @param[in] numServersEC The number of Edge servers for the simulation.
+ * @param[in] numServersCC The number of Cloud servers for the simulation.
+ * @param[in] techType The mobile network technology ID (e.g., 5 for 5G).
+ * @param[in] bottlenecks If true, activates the bottleneck scenario on every instance.
+ * @param[in] seed The seed of every instance's random context.
+ * @param[in] config The solver parameters shared by every run.
+ */
+void initializeMathematicalBatch(std::string algorithm, const iVec& deviceCounts, int numServersEC, int numServersCC, int techType, bool bottlenecks = false, uint64_t seed = utils::randomSeed(), MathModels::SolverConfig config = {}) {
+    std::vector<Result> states;
+    std::vector<utils::Rng> rngs;
+    for (int numDevices : deviceCounts) {
+        auto instance = InstanceCache::global().acquire({numDevices, numServersEC, numServersCC, techType, bottlenecks, seed});
+        if (!instance) {
+            std::cout << "Falha na fase de pre-calculo. A simulacao nao pode continuar." << std::endl;
+            continue;
+        }
+        states.push_back(std::move(instance->state));
+        rngs.push_back(instance->rng);
+    }
+    MathModels::bootupBatch(algorithm, states, rngs, config);
+}
+
 /**
  * @brief The main entry point of the simulation program.
- * @details This function sets up the simulation parameters and runs a batch of
+ * @details Given an experiment file (`main_app experiments/default.txt [key=value ...]`),
+ * runs its matrix with `ExperimentRunner::run`; the optional `key=value[,value...]`
+ * arguments override entries of the file. Without arguments, this function sets up the
+ * simulation parameters and runs a batch of
  * simulations. It contains a loop to test the algorithms with an increasing
  * number of devices, allowing for scalability analysis. A global try-catch
  * block is used to handle any exceptions that may occur during the process.
  *
  * @return Returns 0 on successful completion.
  */
-int main() {
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        try {
+            auto experiment = ExperimentRunner::load(argv[1], std::vector<std::string>(argv + 2, argv + argc));
+            if (!experiment) return 1;
+            const bool ok = ExperimentRunner::run(*experiment);
+            Profiling::Trace::global().write();
+            return ok ? 0 : 1;
+        } catch (const std::exception& e) {
+            std::cout << "Falha na simulacao: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     int numDevices = 300;
     int numServersEC = 100;
     int numServersCC = 5;
     int techType = 4;
     bool bottlenecks = true;
+    std::string traceFile = ""; // e.g. "Results/trace.json" to record a Chrome trace of every phase
+    uint64_t seed = utils::randomSeed(); // shared by every algorithm, so they all run on the same instances
     
     try {
+        if (!traceFile.empty()) Profiling::Trace::global().enable(traceFile);
+
+        // The mathematical model runs once for every size, with the sizes solved concurrently.
+        iVec deviceCounts;
+        for (int d = numDevices; d <= 500; d += 100) deviceCounts.push_back(d);
+        initializeMathematicalBatch("Minimize_Cost", deviceCounts, numServersEC, numServersCC, techType, bottlenecks, seed);
+
         while (numDevices <= 500) {
             std::cout << "\n==============================================================\n" ;
             std::cout <<   "******************** INICIANDO SIMULACOES ********************" ;
             std::cout << "\n==============================================================\n" ;
 
-            initializeSimulation("Mathematical", "Minimize_Cost", numDevices, numServersEC, numServersCC, techType, bottlenecks);
-            initializeSimulation("MetaHeuristic", "SA", numDevices, numServersEC, numServersCC, techType, bottlenecks);
-            initializeSimulation("MetaHeuristic", "SA", numDevices, numServersEC, numServersCC, techType, bottlenecks, "Greedy_DescAsc");
+            initializeSimulation("MetaHeuristic", "SA", numDevices, numServersEC, numServersCC, techType, bottlenecks, "Random", seed);
+            initializeSimulation("MetaHeuristic", "SA", numDevices, numServersEC, numServersCC, techType, bottlenecks, "Greedy_DescAsc", seed);
             numDevices += 100;
 
             std::cout << "\n==============================================================\n" ;
@@ -79,6 +145,8 @@ int main() {
             std::cout << "\n==============================================================\n" ;
         }
 
+        ResultsSink::global().flush();
+        Profiling::Trace::global().write();
     } catch (const std::exception& e) {
         std::cout << "Falha na simulacao: " << e.what() << std::endl;
     }